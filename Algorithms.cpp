@@ -1,55 +1,196 @@
 #include "Algorithms.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <tuple>
 
-Algorithms::Algorithms(const std::vector<std::string>& maze) : maze(maze) {}
+SearchBudget SearchBudget::within(std::chrono::microseconds limit, const std::atomic<bool>* cancel) {
+    SearchBudget budget;
+    budget.deadline = std::chrono::steady_clock::now() + limit;
+    budget.cancel = cancel;
+    return budget;
+}
+
+bool SearchBudget::exhausted() const {
+    if (cancel && cancel->load(std::memory_order_relaxed))
+        return true;
+    return deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= deadline;
+}
+
+const Algorithms::Point Algorithms::directions[4] = { {-1,0},{1,0},{0,-1},{0,1} };
+
+Algorithms::Algorithms(const std::vector<std::string>& maze, CellOrder order) {
+    int mazeRows = static_cast<int>(maze.size());
+    buildMoves(maze, mazeRows, mazeRows > 0 ? static_cast<int>(maze[0].size()) : 0, order);
+}
 
-std::string Algorithms::pointToStr(Point p) const {
-    return std::to_string(p.first) + "," + std::to_string(p.second);
+Algorithms::Algorithms(const GridView& maze, CellOrder order) {
+    buildMoves(maze, maze.getRows(), maze.getCols(), order);
 }
 
-// General function to get neighbors of a point for all algorithms
-std::vector<Algorithms::Point> Algorithms::getNeighbors(Point p) const {
-    static const std::vector<Point> directions = { {-1,0},{1,0},{0,-1},{0,1} };
-    std::vector<Point> neighbors;
-    for (auto [dx, dy] : directions) {
-        int nx = p.first + dx;
-        int ny = p.second + dy;
-        if (nx >= 0 && ny >= 0 && nx < maze.size() && ny < maze[0].size() && maze[nx][ny] == '.') {
-            neighbors.push_back({ nx, ny });
+// Cell (i, j) is character (2i + 1, 2j + 1), and an open passage opens the
+// wall character next to it both ways
+Algorithms::Algorithms(const std::vector<uint8_t>& passages, int cellRows, int cellCols, CellOrder order) {
+    setSize(2 * cellRows + 1, 2 * cellCols + 1, order);
+    if (cellRows <= 0 || cellCols <= 0)
+        return;
+    for (int i = 0; i < cellRows; i++) {
+        for (int j = 0; j < cellCols; j++) {
+            uint8_t mask = passages[static_cast<size_t>(i) * cellCols + j] & 15;
+            int r = 2 * i + 1, c = 2 * j + 1;
+            moves[layout.index(r, c)] = openCell | mask;
+            if (mask & East)
+                moves[layout.index(r, c + 1)] = openCell | West | East;
+            if (mask & South)
+                moves[layout.index(r + 1, c)] = openCell | North | South;
         }
     }
-    return neighbors;
+    // Entry point and exit
+    moves[layout.index(0, 1)] = openCell | South;
+    moves[layout.index(1, 1)] |= North;
+    moves[layout.index(rows - 1, cols - 2)] = openCell | North;
+    moves[layout.index(rows - 2, cols - 2)] |= South;
+}
+
+void Algorithms::setSize(int mazeRows, int mazeCols, CellOrder order) {
+    rows = mazeRows;
+    cols = mazeCols;
+    layout = GridLayout(rows, cols, order);
+    moves.assign(layout.size(), 0);
+    stamp.assign(layout.size(), 0);
+    cameFrom.assign(layout.size(), noParent);
+    cost.assign(layout.size(), 0);
+    closedIn.assign(layout.size(), 0);
 }
 
-bool Algorithms::runDijkstra(Point start, Point goal) {
+template <class Grid>
+void Algorithms::buildMoves(const Grid& maze, int mazeRows, int mazeCols, CellOrder order) {
+    setSize(mazeRows, mazeCols, order);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            if (maze[r][c] != '.')
+                continue;
+            uint8_t mask = openCell;
+            if (r > 0 && maze[r - 1][c] == '.')
+                mask |= North;
+            if (r + 1 < rows && maze[r + 1][c] == '.')
+                mask |= South;
+            if (c > 0 && maze[r][c - 1] == '.')
+                mask |= West;
+            if (c + 1 < cols && maze[r][c + 1] == '.')
+                mask |= East;
+            moves[layout.index(r, c)] = mask;
+        }
+    }
+}
+
+void Algorithms::setComponents(const ComponentLabeler* labels) {
+    components = labels;
+}
+
+bool Algorithms::isOpen(Point p) const {
+    return p.first >= 0 && p.second >= 0 && p.first < rows && p.second < cols && (moves[layout.index(p.first, p.second)] & openCell);
+}
+
+// O(1) rejection of start/goal pairs that can never be connected
+bool Algorithms::unreachable(Point start, Point goal) const {
+    if (!isOpen(start) || !isOpen(goal))
+        return true;
+    return components && !components->empty() && !components->connected(start, goal);
+}
+
+void Algorithms::beginQuery() {
     visited.clear();
     path.clear();
-    cameFrom.clear();
+    optimal = false;
+    interrupted = false;
+    newSearch();
+}
 
-    std::unordered_map<std::string, int> weights;
+void Algorithms::newRound() {
+    if (++round == 0) {
+        std::fill(closedIn.begin(), closedIn.end(), 0);
+        round = 1;
+    }
+}
+
+void Algorithms::newSearch() {
+    // only when the counter wraps around do the stamps have to be wiped
+    if (++epoch == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        epoch = 1;
+    }
+}
+
+// Reading the clock on every expansion would cost more than the expansion
+// itself, so the budget is only looked at every 64 expansions
+bool Algorithms::outOfBudget(const SearchBudget& budget, long long& expansions) {
+    return (++expansions & 63) == 0 && budget.exhausted();
+}
+
+// Manhattan distance, used both as the A* heuristic and to pick the best
+// partial result when a search is interrupted
+int Algorithms::distanceToGoal(Point p, Point goal) const {
+    return std::abs(p.first - goal.first) + std::abs(p.second - goal.second);
+}
+
+// General function to get neighbors of a point for all algorithms.
+// Walks the set bits of the cell's passage mask, lowest bit first.
+int Algorithms::getNeighbors(Point p, Step out[4]) const {
+    static const uint8_t lowestBit[16] = { 0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0 };
+    int count = 0;
+    for (unsigned mask = moves[layout.index(p.first, p.second)] & 15u; mask != 0; mask &= mask - 1) {
+        uint8_t d = lowestBit[mask];
+        out[count++] = { { p.first + directions[d].first, p.second + directions[d].second }, d };
+    }
+    return count;
+}
+
+bool Algorithms::runDijkstra(Point start, Point goal, const SearchBudget& budget) {
+    beginQuery();
+
+    if (unreachable(start, goal))
+        return false;
 
     // Min-heap: pairs of (cost, point)
     std::priority_queue<std::pair<int, Point>,std::vector<std::pair<int, Point>>,std::greater<>> myHeap;
 
-    weights[pointToStr(start)] = 0;
+    size_t startIndex = layout.index(start.first, start.second);
+    reach(startIndex, noParent);
+    cost[startIndex] = 0;
     myHeap.push({ 0, start });
+    Point closest = start;
+    long long expansions = 0;
 
     while (!myHeap.empty()) {
+        if (outOfBudget(budget, expansions)) {
+            interrupted = true;
+            drawFinalPath(start, closest);
+            return false;
+        }
+
         auto [currentCost, current] = myHeap.top();
         myHeap.pop();
 
         visited.push_back(current);
         if (current == goal) {
             drawFinalPath(start, goal);
+            optimal = true;
             return true;
         }
+        if (distanceToGoal(current, goal) < distanceToGoal(closest, goal))
+            closest = current;
 
-        for (auto neighbor : getNeighbors(current)) {
+        Step steps[4];
+        int count = getNeighbors(current, steps);
+        for (int k = 0; k < count; k++) {
+            Point neighbor = steps[k].to;
+            size_t i = layout.index(neighbor.first, neighbor.second);
             int newWeight = currentCost + 1;
-            std::string neighborKey = pointToStr(neighbor);
-            if (!weights.count(neighborKey) || newWeight < weights[neighborKey]) {
-                weights[neighborKey] = newWeight;
+            if (!reached(i) || newWeight < cost[i]) {
+                reach(i, steps[k].dir);
+                cost[i] = newWeight;
                 myHeap.push({ newWeight, neighbor });
-                cameFrom[neighborKey] = current;
             }
         }
     }
@@ -58,33 +199,45 @@ bool Algorithms::runDijkstra(Point start, Point goal) {
 }
 
 
-bool Algorithms::runBFS(Point start, Point goal) {
-    visited.clear();
-    path.clear();
-    cameFrom.clear();
+bool Algorithms::runBFS(Point start, Point goal, const SearchBudget& budget) {
+    beginQuery();
+
+    if (unreachable(start, goal))
+        return false;
 
     std::queue<Point> q;
-    std::unordered_set<std::string> visitedSet;
 
     q.push(start);
-    visitedSet.insert(pointToStr(start));
+    reach(layout.index(start.first, start.second), noParent);
+    Point closest = start;
+    long long expansions = 0;
 
     while (!q.empty()) {
+        if (outOfBudget(budget, expansions)) {
+            interrupted = true;
+            drawFinalPath(start, closest);
+            return false;
+        }
+
         Point current = q.front();
         q.pop();
 
         visited.push_back(current);
         if (current == goal) {
             drawFinalPath(start, goal);
+            optimal = true;
             return true;
         }
+        if (distanceToGoal(current, goal) < distanceToGoal(closest, goal))
+            closest = current;
 
-        for (auto neighbor : getNeighbors(current)) {
-            std::string neighborKey = pointToStr(neighbor);
-            if (!visitedSet.count(neighborKey)) {
-                q.push(neighbor);
-                visitedSet.insert(neighborKey);
-                cameFrom[neighborKey] = current;
+        Step steps[4];
+        int count = getNeighbors(current, steps);
+        for (int k = 0; k < count; k++) {
+            size_t i = layout.index(steps[k].to.first, steps[k].to.second);
+            if (!reached(i)) {
+                q.push(steps[k].to);
+                reach(i, steps[k].dir);
             }
         }
     }
@@ -92,37 +245,173 @@ bool Algorithms::runBFS(Point start, Point goal) {
     return false;
 }
 
-bool Algorithms::runDFS(Point start, Point goal) {
-    visited.clear();
-    path.clear();
-    cameFrom.clear();
+bool Algorithms::runDFS(Point start, Point goal, const SearchBudget& budget) {
+    beginQuery();
+
+    if (unreachable(start, goal))
+        return false;
 
     std::stack<Point> stk;
-    std::unordered_set<std::string> visitedSet;
 
     stk.push(start);
-    visitedSet.insert(pointToStr(start));
+    reach(layout.index(start.first, start.second), noParent);
+    Point closest = start;
+    long long expansions = 0;
 
     while (!stk.empty()) {
+        if (outOfBudget(budget, expansions)) {
+            interrupted = true;
+            drawFinalPath(start, closest);
+            return false;
+        }
+
         Point current = stk.top();
         stk.pop();
 
         visited.push_back(current);
+        // DFS paths are valid but not necessarily shortest, so optimal stays false
         if (current == goal) {
             drawFinalPath(start, goal);
             return true;
         }
+        if (distanceToGoal(current, goal) < distanceToGoal(closest, goal))
+            closest = current;
+
+        Step steps[4];
+        int count = getNeighbors(current, steps);
+        for (int k = 0; k < count; k++) {
+            size_t i = layout.index(steps[k].to.first, steps[k].to.second);
+            if (!reached(i)) {
+                stk.push(steps[k].to);
+                reach(i, steps[k].dir);
+            }
+        }
+    }
+
+    return false;
+}
+
+// Anytime Repairing A* (Likhachev et al., "ARA*: Anytime A* with Provable
+// Bounds on Sub-Optimality")
+// https://papers.nips.cc/paper/2382-ara-anytime-a-with-provable-bounds-on-sub-optimality
+// Weighted A* with a decreasing weight, where each round carries on from the
+// last instead of starting over: costs and parents are kept, and cells that
+// got cheaper after being expanded in a round are expanded again in the next
+// one. A round stops once the goal is within w of the best left in the open
+// list, and the search stops once nothing left can lead to a shorter path.
+bool Algorithms::runAnytimeAStar(Point start, Point goal, const SearchBudget& budget) {
+    beginQuery();
+
+    if (unreachable(start, goal))
+        return false;
+
+    static const double inflation[] = { 5.0, 3.0, 2.0, 1.5, 1.0 };
+    // Min-heap kept with std::push_heap / pop_heap: (f = g + w * h, g, point)
+    using Entry = std::tuple<double, int, Point>;
+    std::vector<Entry> openList;
+    std::vector<Entry> inconsistent; // got cheaper after being closed this round
+    std::greater<Entry> later;
+
+    size_t startIndex = layout.index(start.first, start.second);
+    size_t goalIndex = layout.index(goal.first, goal.second);
+    reach(startIndex, noParent);
+    cost[startIndex] = 0;
+    openList.push_back({ 0.0, 0, start });
+    Point closest = start;
+    long long expansions = 0;
+    // so no cell counts as closed in the round before the first
+    newRound();
+
+    for (double w : inflation) {
+        // whatever is still open, plus the inconsistent cells, makes up the
+        // open list of the next round, keyed by the new weight
+        uint32_t lastRound = round;
+        newRound();
+        std::vector<Entry> next;
+        for (const Entry& e : openList) {
+            size_t i = layout.index(std::get<2>(e).first, std::get<2>(e).second);
+            if (std::get<1>(e) == cost[i] && closedIn[i] != lastRound)
+                next.push_back(e);
+        }
+        for (const Entry& e : inconsistent) {
+            if (std::get<1>(e) == cost[layout.index(std::get<2>(e).first, std::get<2>(e).second)])
+                next.push_back(e);
+        }
+        inconsistent.clear();
+        for (Entry& e : next)
+            std::get<0>(e) = std::get<1>(e) + w * distanceToGoal(std::get<2>(e), goal);
+        openList.swap(next);
+        std::make_heap(openList.begin(), openList.end(), later);
+
+        while (!openList.empty()) {
+            auto [f, currentCost, current] = openList.front();
+            size_t currentIndex = layout.index(current.first, current.second);
+            // skip stale heap entries
+            if (currentCost != cost[currentIndex] || closedIn[currentIndex] == round) {
+                std::pop_heap(openList.begin(), openList.end(), later);
+                openList.pop_back();
+                continue;
+            }
+            if (reached(goalIndex) && cost[goalIndex] <= f)
+                break;
+            if (outOfBudget(budget, expansions)) {
+                interrupted = true;
+                break;
+            }
+            std::pop_heap(openList.begin(), openList.end(), later);
+            openList.pop_back();
+
+            closedIn[currentIndex] = round;
+            visited.push_back(current);
+            if (distanceToGoal(current, goal) < distanceToGoal(closest, goal))
+                closest = current;
+
+            Step steps[4];
+            int count = getNeighbors(current, steps);
+            for (int k = 0; k < count; k++) {
+                Point neighbor = steps[k].to;
+                size_t i = layout.index(neighbor.first, neighbor.second);
+                int newWeight = currentCost + 1;
+                if (!reached(i) || newWeight < cost[i]) {
+                    reach(i, steps[k].dir);
+                    cost[i] = newWeight;
+                    Entry e{ newWeight + w * distanceToGoal(neighbor, goal), newWeight, neighbor };
+                    if (closedIn[i] == round) {
+                        inconsistent.push_back(e);
+                    }
+                    else {
+                        openList.push_back(e);
+                        std::push_heap(openList.begin(), openList.end(), later);
+                    }
+                }
+            }
+        }
+        if (interrupted)
+            break;
 
-        for (auto neighbor : getNeighbors(current)) {
-            std::string neighborKey = pointToStr(neighbor);
-            if (!visitedSet.count(neighborKey)) {
-                stk.push(neighbor);
-                visitedSet.insert(neighborKey);
-                cameFrom[neighborKey] = current;
+        // smallest unweighted f of anything that could still be expanded
+        int bound = INT_MAX;
+        for (const std::vector<Entry>* list : { &openList, &inconsistent }) {
+            for (const Entry& e : *list) {
+                size_t i = layout.index(std::get<2>(e).first, std::get<2>(e).second);
+                if (std::get<1>(e) == cost[i] && (list == &inconsistent || closedIn[i] != round))
+                    bound = std::min(bound, std::get<1>(e) + distanceToGoal(std::get<2>(e), goal));
             }
         }
+        if (!reached(goalIndex) && bound == INT_MAX)
+            break;
+        if (reached(goalIndex) && bound >= cost[goalIndex]) {
+            optimal = true;
+            break;
+        }
     }
 
+    if (reached(goalIndex)) {
+        drawFinalPath(start, goal);
+        return true;
+    }
+    if (interrupted)
+        drawFinalPath(start, closest);
     return false;
 }
 
@@ -130,7 +419,8 @@ void Algorithms::drawFinalPath(Point start, Point goal) {
     Point current = goal;
     while (current != start) {
         path.push_back(current);
-        current = cameFrom[pointToStr(current)];
+        Point step = directions[cameFrom[layout.index(current.first, current.second)]];
+        current = { current.first - step.first, current.second - step.second };
     }
     path.push_back(start);
     std::reverse(path.begin(), path.end());
@@ -142,4 +432,12 @@ const std::vector<Algorithms::Point>& Algorithms::getVisited() const {
 
 const std::vector<Algorithms::Point>& Algorithms::getPath() const {
     return path;
-}
\ No newline at end of file
+}
+
+bool Algorithms::isOptimal() const {
+    return optimal;
+}
+
+bool Algorithms::wasInterrupted() const {
+    return interrupted;
+}
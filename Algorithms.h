@@ -5,8 +5,23 @@
 #include <queue>
 #include <stack>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include "ComponentLabeler.h"
+#include "GridLayout.h"
+#include "Passages.h"
+#include "GridView.h"
+
+// Limits for a single query. A search gives up once the deadline has
+// passed or once *cancel becomes true (set from any thread).
+struct SearchBudget {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    const std::atomic<bool>* cancel = nullptr;
+
+    static SearchBudget within(std::chrono::microseconds limit, const std::atomic<bool>* cancel = nullptr);
+    bool exhausted() const;
+};
 
 class Algorithms {
 public:
@@ -14,23 +29,90 @@ public:
     // Reference -> https://en.cppreference.com/w/cpp/language/type_alias
     using Point = std::pair<int, int>;
 
-    Algorithms(const std::vector<std::string>& maze);
+    // order picks how the solver's per-cell arrays are laid out in memory,
+    // see GridLayout.h. Results are the same for every order.
+    Algorithms(const std::vector<std::string>& maze, CellOrder order = CellOrder::Tiled);
+    // Same, straight from a loaded file (see MazeLoader.h) without copying it into strings
+    Algorithms(const GridView& maze, CellOrder order = CellOrder::Tiled);
+    // Same, from the passage masks MazeGenerator::getPassages() hands out, so
+    // they are not worked out again from the characters. Points are still in
+    // the 2x+1 character grid, with the entrance and exit where the
+    // generator opens them.
+    Algorithms(const std::vector<uint8_t>& passages, int cellRows, int cellCols, CellOrder order = CellOrder::Tiled);
 
-    bool runDijkstra(Point start, Point goal);
-    bool runBFS(Point start, Point goal);
-    bool runDFS(Point start, Point goal);
+    // Optional component labels for this maze. When set, queries between
+    // cells in different components fail straight away without searching.
+    // The labeler has to outlive the solver.
+    void setComponents(const ComponentLabeler* labels);
+
+    // All solvers return true if they found a path to the goal. If the budget
+    // runs out first, getPath() holds the best partial result instead: the
+    // route to the explored cell closest to the goal.
+    bool runDijkstra(Point start, Point goal, const SearchBudget& budget = SearchBudget());
+    bool runBFS(Point start, Point goal, const SearchBudget& budget = SearchBudget());
+    bool runDFS(Point start, Point goal, const SearchBudget& budget = SearchBudget());
+    // Anytime A* (ARA*): weighted A* with a decreasing weight that reuses the
+    // previous round's work. Returns quickly with a valid but possibly longer
+    // path and keeps improving it until it is proven shortest or the budget
+    // runs out. getVisited() holds the cells expanded over all rounds.
+    bool runAnytimeAStar(Point start, Point goal, const SearchBudget& budget = SearchBudget());
 
     const std::vector<Point>& getVisited() const;
     const std::vector<Point>& getPath() const;
+    // true if getPath() is known to be a shortest path
+    bool isOptimal() const;
+    // true if the last query was stopped by its deadline or cancel token
+    bool wasInterrupted() const;
 
 private:
-    std::vector<std::string> maze;
+    // one step from a cell to an open neighbour, dir indexes directions[]
+    struct Step {
+        Point to;
+        uint8_t dir;
+    };
+    // directions[d] is the move for passage bit (1 << d), see Passages.h
+    static const Point directions[4];
+    static constexpr uint8_t noParent = 4;
+    // set in moves[] for every open cell, on top of its passage bits
+    static constexpr uint8_t openCell = 16;
+
+    int rows = 0, cols = 0;
+    GridLayout layout;
+    // All per-cell arrays below are indexed by layout.index(r, c)
+    // Passage mask of every cell, precomputed once so expanding a cell is a
+    // walk over its set bits with no bounds checks or grid lookups
+    std::vector<uint8_t> moves;
+    // A cell has been reached in the current search if stamp == epoch, which
+    // saves clearing every array before each search
+    std::vector<uint32_t> stamp;
+    std::vector<uint8_t> cameFrom;
+    std::vector<int> cost;
+    uint32_t epoch = 0;
+    // Anytime A* round in which a cell was last expanded, same trick as stamp
+    std::vector<uint32_t> closedIn;
+    uint32_t round = 0;
+
     std::vector<Point> visited;
     std::vector<Point> path;
+    const ComponentLabeler* components = nullptr;
+    bool optimal = false;
+    bool interrupted = false;
 
-    std::unordered_map<std::string, Point> cameFrom;
-    std::vector<Point> getNeighbors(Point p) const;
-    std::string pointToStr(Point p) const;
+    // Sizes every per-cell array for a rows x cols grid, all cells walls
+    void setSize(int rows, int cols, CellOrder order);
+    // Grid is anything where maze[r][c] is a char
+    template <class Grid>
+    void buildMoves(const Grid& maze, int rows, int cols, CellOrder order);
+    int getNeighbors(Point p, Step out[4]) const;
+    bool isOpen(Point p) const;
+    bool unreachable(Point start, Point goal) const;
+    void beginQuery();
+    void newSearch();
+    void newRound();
+    bool reached(size_t i) const { return stamp[i] == epoch; }
+    void reach(size_t i, uint8_t dir) { stamp[i] = epoch; cameFrom[i] = dir; }
+    bool outOfBudget(const SearchBudget& budget, long long& expansions);
+    int distanceToGoal(Point p, Point goal) const;
     void drawFinalPath(Point start, Point goal);
 };
 
@@ -0,0 +1,149 @@
+#include "AsyncMazeLoader.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+AsyncMazeLoader::~AsyncMazeLoader() {
+    if (worker.joinable())
+        worker.join();
+}
+
+bool AsyncMazeLoader::start(const std::string& name, Labels labels) {
+    filename = name;
+    labelling = labels;
+    binaryFile = BinaryMazeFile::isBinaryMaze(filename);
+    if (binaryFile) {
+        if (!binary.load(filename))
+            return false;
+        rows = binary.getRows();
+        cols = binary.getCols();
+        seed = binary.getHeader().seed;
+        seedKnown = true;
+    }
+    else {
+        if (!text.open(filename))
+            return false;
+        rows = text.getView().getRows();
+        cols = text.getView().getCols();
+        std::string savedSeed = text.headerField("seed");
+        seedKnown = Rng::parseSeed(savedSeed, seed);
+        if (!savedSeed.empty() && !seedKnown)
+            std::cerr << filename << ": ignoring the seed in the header, " << savedSeed << " is not a valid seed" << std::endl;
+    }
+
+    // the renderer and the solvers take the entrance at (0, 1) and the exit
+    // at (rows - 1, cols - 2) for granted
+    if (rows < 3 || cols < 3) {
+        std::cerr << filename << ": the maze is only " << rows << " x " << cols << ", it needs to be at least 3 x 3" << std::endl;
+        return false;
+    }
+    if (!binaryFile && (!text.checkRows(0, 1) || !text.checkRows(rows - 1, rows)))
+        return false;
+    bool hasEntrance = binaryFile ? binary.isOpen(0, 1) : text.getView()[0][1] == '.';
+    bool hasExit = binaryFile ? binary.isOpen(rows - 1, cols - 2) : text.getView()[rows - 1][cols - 2] == '.';
+    if (!hasEntrance || !hasExit) {
+        std::cerr << filename << ": the maze has no " << (hasEntrance ? "exit" : "entrance") << std::endl;
+        return false;
+    }
+
+    // sized now so the rows never move while the window reads them
+    maze.resize(rows);
+    worker = std::thread(&AsyncMazeLoader::readMaze, this);
+    return true;
+}
+
+void AsyncMazeLoader::readMaze() {
+    if (binaryFile) {
+        std::vector<std::string> decoded = binary.toMaze();
+        // never hand out fewer rows than start() promised
+        if (decoded.size() != static_cast<size_t>(rows) || decoded[0].size() != static_cast<size_t>(cols)) {
+            std::cerr << "Something went wrong decoding " << filename << std::endl;
+            broken = true;
+            done = true;
+            return;
+        }
+        maze = std::move(decoded);
+        ready.store(rows, std::memory_order_release);
+    }
+    else {
+        const GridView& view = text.getView();
+        for (int first = 0; first < rows; first += bandRows) {
+            int last = std::min(rows, first + bandRows);
+            if (!text.checkRows(first, last)) {
+                broken = true;
+                done = true;
+                return;
+            }
+            for (int r = first; r < last; r++)
+                maze[r].assign(view[r], cols);
+            ready.store(last, std::memory_order_release);
+        }
+    }
+
+    if (labelling == Labels::Skip) {
+        done = true;
+        return;
+    }
+    std::string sidecar = MazeIndexFile::sidecarFor(filename);
+    if (labelling == Labels::UseIndex && std::ifstream(sidecar) && index.load(sidecar)) {
+        if (index.matches(rows, cols, MazeIndexFile::fingerprint(maze))) {
+            components = index.components();
+            std::cout << "Using " << sidecar << std::endl;
+        }
+        else {
+            std::cout << "Ignoring " << sidecar << ", it was built for a different maze" << std::endl;
+        }
+    }
+    if (components.empty())
+        components = ComponentLabeler(maze);
+    done = true;
+}
+
+bool AsyncMazeLoader::wait() {
+    if (worker.joinable())
+        worker.join();
+    return !broken;
+}
+
+bool AsyncMazeLoader::finished() const {
+    return done;
+}
+
+bool AsyncMazeLoader::failed() const {
+    return broken;
+}
+
+int AsyncMazeLoader::getRows() const {
+    return rows;
+}
+
+int AsyncMazeLoader::getCols() const {
+    return cols;
+}
+
+bool AsyncMazeLoader::hasSeed() const {
+    return seedKnown;
+}
+
+uint64_t AsyncMazeLoader::getSeed() const {
+    return seed;
+}
+
+int AsyncMazeLoader::rowsReady() const {
+    return ready.load(std::memory_order_acquire);
+}
+
+const std::vector<std::string>& AsyncMazeLoader::getMaze() const {
+    return maze;
+}
+
+std::vector<std::string> AsyncMazeLoader::takeMaze() {
+    wait();
+    ready = 0;
+    return std::move(maze);
+}
+
+ComponentLabeler AsyncMazeLoader::takeComponents() {
+    wait();
+    return std::move(components);
+}
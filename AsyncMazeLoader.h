@@ -0,0 +1,83 @@
+#ifndef ASYNC_MAZE_LOADER_H
+#define ASYNC_MAZE_LOADER_H
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include "MazeLoader.h"
+#include "BinaryMazeFile.h"
+#include "MazeIndexFile.h"
+#include "ComponentLabeler.h"
+
+// Reads a maze file on a worker thread so the window can open straight away.
+//
+// start() only looks at the header, which is enough for the size and seed.
+// Text files are then read in bands of rows, and every finished band shows
+// up in rowsReady(), so a big maze fills in from the top while the rest is
+// still being read. Binary files are decoded in one go, since that is quick
+// next to parsing text. Once every row is in, the component labels come
+// from an up to date sidecar index (see MazeIndexFile.h) or are worked out,
+// unless the caller has no use for them, and finished() turns true.
+class AsyncMazeLoader {
+public:
+    AsyncMazeLoader() = default;
+    ~AsyncMazeLoader();
+
+    AsyncMazeLoader(const AsyncMazeLoader&) = delete;
+    AsyncMazeLoader& operator=(const AsyncMazeLoader&) = delete;
+
+    // What the worker does for component labels once every row is in.
+    // Compute ignores the sidecar index, e.g. when it is about to be rewritten.
+    enum class Labels { Skip, Compute, UseIndex };
+
+    // Prints what went wrong and returns false if the file can't be opened,
+    // is smaller than 3 x 3 or has no entrance or exit
+    bool start(const std::string& filename, Labels labels = Labels::UseIndex);
+    // Blocks until the worker is done. Returns false if the file was broken.
+    bool wait();
+
+    bool finished() const;
+    bool failed() const;
+
+    int getRows() const;
+    int getCols() const;
+    // false if the file does not say which seed made it
+    bool hasSeed() const;
+    uint64_t getSeed() const;
+
+    // Rows [0, rowsReady()) of getMaze() are complete and will not change.
+    // The rest may be written by the worker, so leave them alone.
+    int rowsReady() const;
+    const std::vector<std::string>& getMaze() const;
+
+    // Once finished(). Labels from the sidecar index point into it, so
+    // they are only valid while the loader is alive. No labels with Skip.
+    std::vector<std::string> takeMaze();
+    ComponentLabeler takeComponents();
+
+private:
+    static const int bandRows = 256;
+
+    std::string filename;
+    bool binaryFile = false;
+    Labels labelling = Labels::UseIndex;
+    MazeLoader text;
+    BinaryMazeFile binary;
+    MazeIndexFile index;
+    int rows = 0, cols = 0;
+    bool seedKnown = false;
+    uint64_t seed = 0;
+
+    std::vector<std::string> maze;
+    ComponentLabeler components;
+    std::atomic<int> ready{ 0 };
+    std::atomic<bool> done{ false };
+    std::atomic<bool> broken{ false };
+    std::thread worker;
+
+    void readMaze();
+};
+
+#endif
@@ -0,0 +1,492 @@
+#include "BinaryMazeFile.h"
+#include "BufferedFileWriter.h"
+#include "MazeGenerator.h"
+#include "Passages.h"
+#include "RangeCoder.h"
+#include "SpanningTreeCodec.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <atomic>
+
+namespace {
+    const char magicBytes[4] = { 'M', 'A', 'Z', 'B' };
+
+    BinaryMazeHeader emptyHeader() {
+        BinaryMazeHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, magicBytes, sizeof(magicBytes));
+        header.version = BinaryMazeFile::version;
+        header.generator = BinaryMazeFile::unknownGenerator;
+        return header;
+    }
+
+    // Context model shared by the Compressed encoder and decoder. local holds
+    // the East / South bits of a height x width tile; the bits of each cell
+    // are coded from what is already known around it: the west cell, the
+    // north cell and the north-east cell. Cells outside the tile count as
+    // walls, so every tile decodes on its own. Passages across the right and
+    // bottom edge of the whole maze are always walls and cost nothing.
+    // codeBit(model, bit) encodes bit, or ignores it and decodes one.
+    template <class CodeBit>
+    void codeTile(uint8_t* local, int height, int width, bool bottomEdge, bool rightEdge, CodeBit codeBit) {
+        BitModel east[32], south[32];
+        auto at = [&](int i, int j) -> uint8_t {
+            return (i < 0 || j < 0 || j >= width) ? 0 : local[static_cast<size_t>(i) * width + j];
+        };
+        for (int i = 0; i < height; i++) {
+            for (int j = 0; j < width; j++) {
+                uint8_t west = at(i, j - 1), north = at(i - 1, j), northEast = at(i - 1, j + 1);
+                int context = ((west & East) ? 1 : 0) | ((north & South) ? 2 : 0) | ((west & South) ? 4 : 0) |
+                              ((northEast & South) ? 8 : 0);
+                uint8_t& cell = local[static_cast<size_t>(i) * width + j];
+                int e = 0, s = 0;
+                if (!(rightEdge && j == width - 1))
+                    e = codeBit(east[context | ((north & East) ? 16 : 0)], (cell & East) ? 1 : 0);
+                if (!(bottomEdge && i == height - 1))
+                    s = codeBit(south[context | (e << 4)], (cell & South) ? 1 : 0);
+                cell = static_cast<uint8_t>((e ? East : 0) | (s ? South : 0));
+            }
+        }
+    }
+
+    int workerCount(int threads, int jobs) {
+        if (threads <= 0)
+            threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        return std::max(1, std::min(threads, jobs));
+    }
+}
+
+uint64_t BinaryMazeFile::fnv1a(const uint8_t* bytes, size_t length, uint64_t hash) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool BinaryMazeFile::writeFile(const std::string& filename, BinaryMazeHeader& header,
+                               const std::vector<BinaryMazeTile>& index, const uint8_t* payload, size_t payloadSize) {
+    const uint8_t* indexBytes = reinterpret_cast<const uint8_t*>(index.data());
+    size_t indexSize = index.size() * sizeof(BinaryMazeTile);
+    header.tileCount = static_cast<uint32_t>(index.size());
+    header.indexOffset = sizeof(BinaryMazeHeader);
+    header.dataOffset = header.indexOffset + indexSize;
+    header.dataSize = payloadSize;
+    header.checksum = fnv1a(payload, payloadSize, fnv1a(indexBytes, indexSize));
+
+    BufferedFileWriter outfile(filename);
+    if (!outfile.isOpen())
+        return false;
+    outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outfile.write(reinterpret_cast<const char*>(indexBytes), indexSize);
+    outfile.write(reinterpret_cast<const char*>(payload), payloadSize);
+    if (!outfile.close()) {
+        std::cerr << "Something went wrong writing " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool BinaryMazeFile::save(const std::string& filename, const BitGrid& grid, uint64_t seed, uint8_t generator) {
+    BinaryMazeHeader header = emptyHeader();
+    header.encoding = static_cast<uint8_t>(MazeEncoding::Bits);
+    header.generator = generator;
+    header.rows = static_cast<uint32_t>(grid.getRows());
+    header.cols = static_cast<uint32_t>(grid.getCols());
+    header.seed = seed;
+    size_t size = static_cast<size_t>(grid.getRows()) * grid.wordsPerRow() * sizeof(uint64_t);
+    const uint8_t* words = size > 0 ? reinterpret_cast<const uint8_t*>(grid.row(0)) : nullptr;
+    return writeFile(filename, header, {}, words, size);
+}
+
+bool BinaryMazeFile::save(const std::string& filename, const MazeGenerator& generator, int tileSize,
+                          MazeEncoding encoding, int threads) {
+    return save(filename, generator.getPassages(), generator.getCellRows(), generator.getCellCols(), generator.getSeed(),
+                static_cast<uint8_t>(generator.getAlgorithm()), tileSize, encoding, threads);
+}
+
+bool BinaryMazeFile::passagesOf(const std::vector<std::string>& maze, std::vector<uint8_t>& cells) {
+    int rows = static_cast<int>(maze.size());
+    int cols = rows > 0 ? static_cast<int>(maze[0].size()) : 0;
+    if (rows < 3 || cols < 3 || rows % 2 == 0 || cols % 2 == 0)
+        return false;
+    int cellRows = rows / 2, cellCols = cols / 2;
+    cells.assign(static_cast<size_t>(cellRows) * cellCols, 0);
+    for (int r = 0; r < rows; r++) {
+        if (static_cast<int>(maze[r].size()) != cols)
+            return false;
+        for (int c = 0; c < cols; c++) {
+            bool open = maze[r][c] == '.';
+            bool border = r == 0 || c == 0 || r == rows - 1 || c == cols - 1;
+            if (border) {
+                bool door = (r == 0 && c == 1) || (r == rows - 1 && c == cols - 2);
+                if (open != door)
+                    return false;
+            }
+            else if (r % 2 == 1 && c % 2 == 1) {
+                if (!open)
+                    return false;
+            }
+            else if (r % 2 == 0 && c % 2 == 0) {
+                if (open)
+                    return false;
+            }
+            else if (open) {
+                // a wall between two cells, the one above or to the left of it opens towards the other
+                size_t before = static_cast<size_t>((r - 1) / 2) * cellCols + (c - 1) / 2;
+                uint8_t passage = r % 2 == 1 ? East : South;
+                cells[before] |= passage;
+                cells[before + (passage == East ? 1 : cellCols)] |= opposite(passage);
+            }
+        }
+    }
+    return true;
+}
+
+bool BinaryMazeFile::save(const std::string& filename, const std::vector<uint8_t>& cells, int cellRows, int cellCols,
+                          uint64_t seed, uint8_t algorithm, int tileSize, MazeEncoding encoding, int threads) {
+    tileSize = std::max(1, tileSize);
+
+    if (encoding == MazeEncoding::Bits) {
+        BitGrid grid(2 * cellRows + 1, 2 * cellCols + 1);
+        for (int x = 0; x < cellRows; x++) {
+            for (int y = 0; y < cellCols; y++) {
+                uint8_t mask = cells[static_cast<size_t>(x) * cellCols + y];
+                grid.set(2 * x + 1, 2 * y + 1, true);
+                if (mask & East)
+                    grid.set(2 * x + 1, 2 * y + 2, true);
+                if (mask & South)
+                    grid.set(2 * x + 2, 2 * y + 1, true);
+            }
+        }
+        if (cellRows > 0 && cellCols > 0) {
+            grid.set(0, 1, true);  // Entry point
+            grid.set(grid.getRows() - 1, grid.getCols() - 2, true);  // Exit
+        }
+        return save(filename, grid, seed, algorithm);
+    }
+
+    BinaryMazeHeader header = emptyHeader();
+    header.encoding = static_cast<uint8_t>(encoding);
+    header.generator = algorithm;
+    header.rows = static_cast<uint32_t>(2 * cellRows + 1);
+    header.cols = static_cast<uint32_t>(2 * cellCols + 1);
+    header.seed = seed;
+
+    if (encoding == MazeEncoding::Tree) {
+        std::vector<uint8_t> plane;
+        if (!SpanningTreeCodec::encode(cells, cellRows, cellCols, plane)) {
+            std::cerr << "Only a perfect maze can be saved as a tree" << std::endl;
+            return false;
+        }
+        return writeFile(filename, header, {}, plane.data(), plane.size());
+    }
+    header.tileSize = static_cast<uint32_t>(tileSize);
+
+    int tilesDown = (cellRows + tileSize - 1) / tileSize;
+    int tilesAcross = (cellCols + tileSize - 1) / tileSize;
+    int tileCount = tilesDown * tilesAcross;
+    std::vector<std::vector<uint8_t>> blocks(tileCount);
+
+    auto encodeTile = [&](int t) {
+        int top = (t / tilesAcross) * tileSize, left = (t % tilesAcross) * tileSize;
+        int bottom = std::min(cellRows, top + tileSize), right = std::min(cellCols, left + tileSize);
+        int width = right - left;
+        std::vector<uint8_t>& block = blocks[t];
+        std::vector<uint8_t> local(static_cast<size_t>(bottom - top) * width);
+        for (int x = top; x < bottom; x++)
+            for (int y = left; y < right; y++)
+                local[static_cast<size_t>(x - top) * width + (y - left)] = cells[static_cast<size_t>(x) * cellCols + y] & 15;
+
+        if (encoding == MazeEncoding::Passages) {
+            // two cells per byte, low nibble first
+            block.assign((local.size() + 1) / 2, 0);
+            for (size_t i = 0; i < local.size(); i++)
+                block[i / 2] |= static_cast<uint8_t>(local[i] << ((i & 1) * 4));
+            return;
+        }
+        RangeEncoder coder(block);
+        codeTile(local.data(), bottom - top, width, bottom == cellRows, right == cellCols,
+                 [&](BitModel& model, int bit) { coder.encode(model, bit); return bit; });
+        coder.finish();
+    };
+
+    std::atomic<int> nextTile(0);
+    auto encodeTiles = [&]() {
+        for (int t = nextTile++; t < tileCount; t = nextTile++)
+            encodeTile(t);
+    };
+    std::vector<std::thread> pool;
+    for (int i = 0; i < workerCount(threads, tileCount); i++)
+        pool.emplace_back(encodeTiles);
+    for (auto& worker : pool)
+        worker.join();
+
+    std::vector<BinaryMazeTile> index;
+    index.reserve(tileCount);
+    std::vector<uint8_t> payload;
+    for (const auto& block : blocks) {
+        index.push_back({ payload.size(), static_cast<uint32_t>(block.size()), 0 });
+        payload.insert(payload.end(), block.begin(), block.end());
+    }
+    return writeFile(filename, header, index, payload.data(), payload.size());
+}
+
+bool BinaryMazeFile::isBinaryMaze(const std::string& filename) {
+    std::ifstream infile(filename, std::ios::binary);
+    char magic[sizeof(magicBytes)] = {};
+    infile.read(magic, sizeof(magic));
+    return infile && std::memcmp(magic, magicBytes, sizeof(magicBytes)) == 0;
+}
+
+bool BinaryMazeFile::load(const std::string& filename) {
+    header = nullptr;
+    tiles = nullptr;
+    data = nullptr;
+    file = MappedFile(filename);
+    if (!file.isOpen())
+        return false;
+
+    auto fail = [&](const char* why) {
+        std::cerr << filename << ": " << why << std::endl;
+        file = MappedFile();
+        return false;
+    };
+    if (file.size() < sizeof(BinaryMazeHeader) || std::memcmp(file.data(), magicBytes, sizeof(magicBytes)) != 0)
+        return fail("not a binary maze file");
+
+    // mmap hands back page aligned memory, so the header can be used in place
+    const BinaryMazeHeader* h = reinterpret_cast<const BinaryMazeHeader*>(file.data());
+    if (h->version > version)
+        return fail("written by a newer version");
+    if (h->encoding > static_cast<uint8_t>(MazeEncoding::Tree))
+        return fail("unknown encoding");
+    // the entrance and exit sit on the border, so anything smaller has no maze in it
+    if (h->rows < 3 || h->cols < 3)
+        return fail("maze is smaller than 3 x 3");
+    if (h->rows > INT32_MAX || h->cols > INT32_MAX)
+        return fail("maze is too large");
+    // written as subtractions so huge offsets can't wrap around and pass
+    if (h->indexOffset % 8 != 0 || h->indexOffset > file.size() ||
+        static_cast<uint64_t>(h->tileCount) * sizeof(BinaryMazeTile) > file.size() - h->indexOffset ||
+        h->dataOffset > file.size() || h->dataSize > file.size() - h->dataOffset)
+        return fail("file is truncated");
+
+    uint64_t stride = (h->cols + 63) / 64;
+    if (h->encoding == static_cast<uint8_t>(MazeEncoding::Bits)) {
+        if (h->dataOffset % 8 != 0 || h->dataSize != static_cast<uint64_t>(h->rows) * stride * 8)
+            return fail("data does not match the dimensions");
+    }
+    else if (h->encoding == static_cast<uint8_t>(MazeEncoding::Tree)) {
+        if (h->rows % 2 == 0 || h->cols % 2 == 0 || h->dataSize != static_cast<uint64_t>(h->rows / 2) * SpanningTreeCodec::rowBytes(h->cols / 2))
+            return fail("data does not match the dimensions");
+    }
+    else {
+        uint64_t cellRows = h->rows / 2, cellCols = h->cols / 2;
+        uint64_t tileSize = h->tileSize;
+        if (tileSize == 0 || h->rows % 2 == 0 || h->cols % 2 == 0 ||
+            h->tileCount != ((cellRows + tileSize - 1) / tileSize) * ((cellCols + tileSize - 1) / tileSize))
+            return fail("tile index does not match the dimensions");
+        // the index is tiny next to the data, so every entry is checked now
+        // and lookups never have to
+        const BinaryMazeTile* index = reinterpret_cast<const BinaryMazeTile*>(file.data() + h->indexOffset);
+        uint64_t tilesAcross = (cellCols + tileSize - 1) / tileSize;
+        for (uint32_t t = 0; t < h->tileCount; t++) {
+            uint64_t height = std::min(tileSize, cellRows - (t / tilesAcross) * tileSize);
+            uint64_t width = std::min(tileSize, cellCols - (t % tilesAcross) * tileSize);
+            bool sizeOk = h->encoding == static_cast<uint8_t>(MazeEncoding::Compressed) || index[t].size == (height * width + 1) / 2;
+            if (!sizeOk || index[t].size > h->dataSize || index[t].offset > h->dataSize - index[t].size)
+                return fail("tile index points outside the file");
+        }
+    }
+    header = h;
+    tiles = reinterpret_cast<const BinaryMazeTile*>(file.data() + h->indexOffset);
+    data = reinterpret_cast<const uint8_t*>(file.data() + h->dataOffset);
+    return true;
+}
+
+bool BinaryMazeFile::verify() const {
+    if (!header)
+        return false;
+    uint64_t hash = fnv1a(reinterpret_cast<const uint8_t*>(tiles), header->tileCount * sizeof(BinaryMazeTile));
+    return fnv1a(data, header->dataSize, hash) == header->checksum;
+}
+
+const BinaryMazeHeader& BinaryMazeFile::getHeader() const {
+    return *header;
+}
+
+MazeEncoding BinaryMazeFile::getEncoding() const {
+    return static_cast<MazeEncoding>(header->encoding);
+}
+
+int BinaryMazeFile::getRows() const {
+    return header ? static_cast<int>(header->rows) : 0;
+}
+
+int BinaryMazeFile::getCols() const {
+    return header ? static_cast<int>(header->cols) : 0;
+}
+
+bool BinaryMazeFile::isOpen(int r, int c) const {
+    int rows = getRows(), cols = getCols();
+    if (r < 0 || c < 0 || r >= rows || c >= cols)
+        return false;
+
+    if (getEncoding() == MazeEncoding::Bits) {
+        size_t stride = (static_cast<size_t>(cols) + 63) / 64;
+        const uint64_t* words = reinterpret_cast<const uint64_t*>(data);
+        return (words[static_cast<size_t>(r) * stride + (c >> 6)] >> (c & 63)) & 1;
+    }
+
+    // entrance and exit are the only openings in the border
+    if ((r == 0 && c == 1) || (r == rows - 1 && c == cols - 2))
+        return true;
+    if (r % 2 == 1 && c % 2 == 1)
+        return true;
+    if (r % 2 == 1 && c > 0 && c < cols - 1)
+        return passages(r / 2, c / 2 - 1) & East;
+    if (c % 2 == 1 && r > 0 && r < rows - 1)
+        return passages(r / 2 - 1, c / 2) & South;
+    return false;
+}
+
+uint8_t BinaryMazeFile::passages(int cellRow, int cellCol) const {
+    int cellRows = getRows() / 2, cellCols = getCols() / 2;
+    if (cellRow < 0 || cellCol < 0 || cellRow >= cellRows || cellCol >= cellCols)
+        return 0;
+
+    if (getEncoding() == MazeEncoding::Bits) {
+        // only walls between two cells count, not the entrance or exit
+        int r = 2 * cellRow + 1, c = 2 * cellCol + 1;
+        uint8_t mask = 0;
+        if (cellRow > 0 && isOpen(r - 1, c))
+            mask |= North;
+        if (cellRow + 1 < cellRows && isOpen(r + 1, c))
+            mask |= South;
+        if (cellCol > 0 && isOpen(r, c - 1))
+            mask |= West;
+        if (cellCol + 1 < cellCols && isOpen(r, c + 1))
+            mask |= East;
+        return mask;
+    }
+
+    if (getEncoding() == MazeEncoding::Tree)
+        return SpanningTreeCodec::passages(data, cellRows, cellCols, cellRow, cellCol);
+
+    int tileSize = static_cast<int>(header->tileSize);
+    int tilesAcross = (cellCols + tileSize - 1) / tileSize;
+    auto tileOf = [&](int x, int y) { return static_cast<uint32_t>((x / tileSize) * tilesAcross + y / tileSize); };
+    auto localIndex = [&](int x, int y) {
+        int left = (y / tileSize) * tileSize;
+        return static_cast<size_t>(x % tileSize) * std::min(cellCols - left, tileSize) + (y - left);
+    };
+
+    if (getEncoding() == MazeEncoding::Passages) {
+        size_t local = localIndex(cellRow, cellCol);
+        return (data[tiles[tileOf(cellRow, cellCol)].offset + local / 2] >> ((local & 1) * 4)) & 15;
+    }
+
+    // Compressed tiles only know their own east and south passages, the
+    // north and west ones come from the neighbours, maybe in other tiles
+    auto southEast = [&](int x, int y) { return decodeTile(tileOf(x, y))[localIndex(x, y)]; };
+    uint8_t mask = southEast(cellRow, cellCol);
+    if (cellRow > 0 && (southEast(cellRow - 1, cellCol) & South))
+        mask |= North;
+    if (cellCol > 0 && (southEast(cellRow, cellCol - 1) & East))
+        mask |= West;
+    return mask;
+}
+
+uint8_t BinaryMazeFile::getParent(int cellRow, int cellCol) const {
+    if (!header || getEncoding() != MazeEncoding::Tree || cellRow < 0 || cellCol < 0 || cellRow >= getRows() / 2 || cellCol >= getCols() / 2)
+        return 0;
+    return SpanningTreeCodec::parent(data, getCols() / 2, cellRow, cellCol);
+}
+
+void BinaryMazeFile::tileBounds(uint32_t t, int& top, int& left, int& bottom, int& right) const {
+    int cellRows = getRows() / 2, cellCols = getCols() / 2;
+    int tileSize = static_cast<int>(header->tileSize);
+    int tilesAcross = (cellCols + tileSize - 1) / tileSize;
+    top = static_cast<int>(t / tilesAcross) * tileSize;
+    left = static_cast<int>(t % tilesAcross) * tileSize;
+    bottom = std::min(cellRows, top + tileSize);
+    right = std::min(cellCols, left + tileSize);
+}
+
+std::vector<uint8_t> BinaryMazeFile::decodeTile(uint32_t t) const {
+    if (!header || getEncoding() == MazeEncoding::Bits || getEncoding() == MazeEncoding::Tree || t >= header->tileCount)
+        return {};
+    int top, left, bottom, right;
+    tileBounds(t, top, left, bottom, right);
+    int height = bottom - top, width = right - left;
+    std::vector<uint8_t> local(static_cast<size_t>(height) * width, 0);
+    const uint8_t* block = data + tiles[t].offset;
+
+    if (getEncoding() == MazeEncoding::Passages) {
+        for (size_t i = 0; i < local.size(); i++)
+            local[i] = (block[i / 2] >> ((i & 1) * 4)) & (South | East);
+        return local;
+    }
+    RangeDecoder coder(block, tiles[t].size);
+    codeTile(local.data(), height, width, bottom == getRows() / 2, right == getCols() / 2,
+             [&](BitModel& model, int) { return coder.decode(model); });
+    return local;
+}
+
+std::vector<std::string> BinaryMazeFile::toMaze(int threads) const {
+    int rows = getRows(), cols = getCols();
+    std::vector<std::string> maze(rows, std::string(cols, '#'));
+    if (rows == 0)
+        return maze;
+
+    if (getEncoding() == MazeEncoding::Bits) {
+        size_t stride = (static_cast<size_t>(cols) + 63) / 64;
+        const uint64_t* words = reinterpret_cast<const uint64_t*>(data);
+        for (int r = 0; r < rows; r++) {
+            const uint64_t* row = words + static_cast<size_t>(r) * stride;
+            for (int c = 0; c < cols; c++)
+                if ((row[c >> 6] >> (c & 63)) & 1)
+                    maze[r][c] = '.';
+        }
+        return maze;
+    }
+
+    if (getEncoding() == MazeEncoding::Tree)
+        return SpanningTreeCodec::toMaze(data, rows / 2, cols / 2, threads);
+
+    // Same expansion as MazeGenerator: every cell plus its east and south
+    // walls. Tiles write to different characters, so they can be decoded
+    // on separate threads.
+    int tileCount = static_cast<int>(header->tileCount);
+    std::atomic<int> nextTile(0);
+    auto expandTiles = [&]() {
+        for (int t = nextTile++; t < tileCount; t = nextTile++) {
+            int top, left, bottom, right;
+            tileBounds(t, top, left, bottom, right);
+            std::vector<uint8_t> local = decodeTile(t);
+            size_t i = 0;
+            for (int x = top; x < bottom; x++) {
+                for (int y = left; y < right; y++, i++) {
+                    maze[2 * x + 1][2 * y + 1] = '.';
+                    if (local[i] & East)
+                        maze[2 * x + 1][2 * y + 2] = '.';
+                    if (local[i] & South)
+                        maze[2 * x + 2][2 * y + 1] = '.';
+                }
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 0; i < workerCount(threads, tileCount); i++)
+        pool.emplace_back(expandTiles);
+    for (auto& worker : pool)
+        worker.join();
+
+    maze[0][1] = '.';
+    maze[rows - 1][cols - 2] = '.';
+    return maze;
+}
@@ -0,0 +1,136 @@
+#ifndef BINARY_MAZE_FILE_H
+#define BINARY_MAZE_FILE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "MappedFile.h"
+#include "BitGrid.h"
+
+class MazeGenerator;
+
+// Compact binary maze file, meant to be memory-mapped and used in place.
+//
+//   BinaryMazeHeader      64 bytes at offset 0
+//   tile index            tileCount x BinaryMazeTile at indexOffset
+//   data                  dataSize bytes at dataOffset
+//
+// Encodings:
+//   Bits      the character grid, 1 bit per character exactly as BitGrid
+//             stores it (rows padded to whole 64 bit words). Row r is at
+//             dataOffset + r * wordsPerRow * 8, so there is no tile index.
+//   Passages  one 4-bit passage mask (see Passages.h) per cell, low nibble
+//             first. Cells are grouped in tileSize x tileSize tiles, stored
+//             tile by tile, row-major inside a tile, and the tile index says
+//             where each tile starts. Needs a lattice maze, as MazeGenerator
+//             makes. About the same size as Bits, but addressed by cell.
+//   Compressed the same tiles, but every tile is an independent range coded
+//             block (see RangeCoder.h). Only the east and south passage of
+//             each cell are stored, since the west and north ones are the
+//             neighbours' east and south, and each bit is predicted from the
+//             cells next to it that were already decoded. About 1.5 bits per
+//             cell for a backtracker maze, against 4 for Passages. Tiles can
+//             be decoded in any order and on any thread.
+//   Tree      perfect mazes only: the 2-bit spanning-tree parent of every
+//             cell, see SpanningTreeCodec.h. 2 bits per cell, no tile index,
+//             and getParent() hands the tree straight to anything that wants
+//             to walk it.
+//
+// All numbers are little-endian. The checksum is 64 bit FNV-1a over the
+// index and data, and is only checked when verify() is called, so opening
+// a file never has to read more than the header.
+// Reference -> http://www.isthe.com/chongo/tech/comp/fnv/index.html
+enum class MazeEncoding : uint8_t { Bits = 0, Passages = 1, Compressed = 2, Tree = 3 };
+
+struct BinaryMazeHeader {
+    char magic[4];          // "MAZB"
+    uint16_t version;
+    uint8_t encoding;       // MazeEncoding
+    uint8_t generator;      // MazeGenerator::Algorithm, unknownGenerator if not generated
+    uint32_t rows, cols;    // character grid, cells are (rows / 2) x (cols / 2)
+    uint32_t tileSize;      // cells per tile side
+    uint32_t tileCount;
+    uint64_t seed;
+    uint64_t indexOffset;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+    uint64_t checksum;
+};
+
+// Where one tile lives, relative to dataOffset
+struct BinaryMazeTile {
+    uint64_t offset;
+    uint32_t size;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(BinaryMazeHeader) == 64, "header layout is part of the file format");
+static_assert(sizeof(BinaryMazeTile) == 16, "tile layout is part of the file format");
+
+class BinaryMazeFile {
+public:
+    static constexpr uint16_t version = 1;
+    static constexpr uint8_t unknownGenerator = 255;
+
+    // Bits encoding of any character maze
+    static bool save(const std::string& filename, const BitGrid& grid, uint64_t seed = 0, uint8_t generator = unknownGenerator);
+    // Any encoding of a generated maze. Tree fails if the maze has loops. Tiles are
+    // compressed on several threads, threads <= 0 means use
+    // std::thread::hardware_concurrency().
+    static bool save(const std::string& filename, const MazeGenerator& generator, int tileSize = 64,
+                     MazeEncoding encoding = MazeEncoding::Passages, int threads = 0);
+    // Same from the passage masks of a lattice maze, cell (i, j) at
+    // i * cellCols + j, e.g. ones passagesOf() got out of a text file
+    static bool save(const std::string& filename, const std::vector<uint8_t>& cells, int cellRows, int cellCols,
+                     uint64_t seed = 0, uint8_t generator = unknownGenerator, int tileSize = 64,
+                     MazeEncoding encoding = MazeEncoding::Passages, int threads = 0);
+    // Passage masks of a character maze. false if it is not laid out as
+    // cells with walls in between (see MazeGenerator.h) and an entrance and
+    // exit where MazeGenerator puts them, in which case only Bits can store it.
+    static bool passagesOf(const std::vector<std::string>& maze, std::vector<uint8_t>& cells);
+
+    // true if the file starts with the magic bytes of this format
+    static bool isBinaryMaze(const std::string& filename);
+
+    // Maps the file and checks the header. Prints what went wrong and
+    // returns false if it is not a maze file this version can read.
+    bool load(const std::string& filename);
+    // Reads the whole file and compares the checksum
+    bool verify() const;
+
+    const BinaryMazeHeader& getHeader() const;
+    MazeEncoding getEncoding() const;
+    int getRows() const;
+    int getCols() const;
+
+    // '.' or '#' of one character of the grid, for either encoding
+    bool isOpen(int r, int c) const;
+    // Passage mask of one cell, for any encoding. A Compressed file has to
+    // decode the whole tile for it, so use decodeTile() or toMaze() for more
+    // than the odd lookup.
+    uint8_t passages(int cellRow, int cellCol) const;
+    // Passage bit index towards the entrance cell, Tree encoding only
+    uint8_t getParent(int cellRow, int cellCol) const;
+    // East and South bits of every cell of tile t, row-major inside the
+    // tile, for the Passages and Compressed encodings
+    std::vector<uint8_t> decodeTile(uint32_t t) const;
+
+    // Compressed tiles are decoded in parallel
+    std::vector<std::string> toMaze(int threads = 0) const;
+
+    // The checksum, also used by MazeIndexFile
+    static uint64_t fnv1a(const uint8_t* bytes, size_t length, uint64_t hash = 14695981039346656037ull);
+
+private:
+    MappedFile file;
+    const BinaryMazeHeader* header = nullptr;
+    const BinaryMazeTile* tiles = nullptr;
+    const uint8_t* data = nullptr;
+
+    // cells [top, bottom) x [left, right) of tile t
+    void tileBounds(uint32_t t, int& top, int& left, int& bottom, int& right) const;
+    static bool writeFile(const std::string& filename, BinaryMazeHeader& header,
+                          const std::vector<BinaryMazeTile>& index, const uint8_t* payload, size_t payloadSize);
+};
+
+#endif
@@ -0,0 +1,32 @@
+#include "BitGrid.h"
+
+BitGrid::BitGrid(int intRows, int intCols) : rows(intRows), cols(intCols) {
+    stride = (cols + 63) / 64;
+    words.assign(static_cast<size_t>(rows) * stride, 0);
+}
+
+BitGrid BitGrid::fromMaze(const std::vector<std::string>& maze) {
+    BitGrid grid(static_cast<int>(maze.size()), maze.empty() ? 0 : static_cast<int>(maze[0].size()));
+    for (int r = 0; r < grid.rows; r++) {
+        uint64_t* out = grid.row(r);
+        const std::string& line = maze[r];
+        for (int c = 0; c < grid.cols; c++) {
+            if (line[c] == '.')
+                out[c >> 6] |= uint64_t(1) << (c & 63);
+        }
+    }
+    return grid;
+}
+
+std::vector<std::string> BitGrid::toMaze() const {
+    std::vector<std::string> maze(rows, std::string(cols, '#'));
+    for (int r = 0; r < rows; r++) {
+        const uint64_t* in = row(r);
+        std::string& line = maze[r];
+        for (int c = 0; c < cols; c++) {
+            if ((in[c >> 6] >> (c & 63)) & 1)
+                line[c] = '.';
+        }
+    }
+    return maze;
+}
@@ -0,0 +1,41 @@
+#ifndef BIT_GRID_H
+#define BIT_GRID_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Maze stored as one bit per cell, 1 = open ('.'), 0 = wall ('#').
+// Each row is padded to a whole number of 64 bit words and column c lives in
+// bit (c % 64) of word (c / 64). Padding bits are always 0.
+class BitGrid {
+public:
+    BitGrid() = default;
+    BitGrid(int rows, int cols);
+
+    static BitGrid fromMaze(const std::vector<std::string>& maze);
+    std::vector<std::string> toMaze() const;
+
+    bool get(int r, int c) const {
+        return (words[static_cast<size_t>(r) * stride + (c >> 6)] >> (c & 63)) & 1;
+    }
+    void set(int r, int c, bool open) {
+        uint64_t& w = words[static_cast<size_t>(r) * stride + (c >> 6)];
+        uint64_t bit = uint64_t(1) << (c & 63);
+        w = open ? (w | bit) : (w & ~bit);
+    }
+
+    uint64_t* row(int r) { return words.data() + static_cast<size_t>(r) * stride; }
+    const uint64_t* row(int r) const { return words.data() + static_cast<size_t>(r) * stride; }
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    int wordsPerRow() const { return stride; }
+
+private:
+    int rows = 0, cols = 0;
+    int stride = 0;
+    std::vector<uint64_t> words;
+};
+
+#endif
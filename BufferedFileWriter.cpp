@@ -0,0 +1,98 @@
+#include "BufferedFileWriter.h"
+#include <iostream>
+
+BufferedFileWriter::BufferedFileWriter(const std::string& filename, bool background)
+    : outfile(filename, std::ios::binary), background(background) {
+    if (!outfile) {
+        std::cerr << "Something went wrong writing " << filename << std::endl;
+        return;
+    }
+    filling.reserve(chunkSize);
+    if (background) {
+        writing.reserve(chunkSize);
+        worker = std::thread(&BufferedFileWriter::writeLoop, this);
+    }
+}
+
+BufferedFileWriter::~BufferedFileWriter() {
+    close();
+}
+
+bool BufferedFileWriter::isOpen() const {
+    return outfile.is_open();
+}
+
+void BufferedFileWriter::write(const char* data, size_t length) {
+    if (!outfile.is_open())
+        return;
+    while (length > 0) {
+        size_t room = chunkSize - filling.size();
+        size_t take = length < room ? length : room;
+        filling.insert(filling.end(), data, data + take);
+        data += take;
+        length -= take;
+        if (filling.size() == chunkSize)
+            flushChunk();
+    }
+}
+
+void BufferedFileWriter::put(char c) {
+    write(&c, 1);
+}
+
+// Hands the full chunk over. In the background case that means waiting for
+// the I/O thread to finish the previous chunk and then swapping buffers, so
+// at most two chunks are ever in memory.
+void BufferedFileWriter::flushChunk() {
+    if (filling.empty())
+        return;
+    if (!background) {
+        if (!outfile.write(filling.data(), static_cast<std::streamsize>(filling.size())))
+            failed = true;
+        filling.clear();
+        return;
+    }
+    std::unique_lock<std::mutex> guard(lock);
+    changed.wait(guard, [this] { return !busy; });
+    writing.swap(filling);
+    busy = true;
+    changed.notify_all();
+    guard.unlock();
+    filling.clear();
+}
+
+void BufferedFileWriter::writeLoop() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        changed.wait(guard, [this] { return busy || stopping; });
+        if (!busy)
+            return;
+        // the chunk is ours until busy goes back to false
+        guard.unlock();
+        bool ok = static_cast<bool>(outfile.write(writing.data(), static_cast<std::streamsize>(writing.size())));
+        writing.clear();
+        guard.lock();
+        if (!ok)
+            failed = true;
+        busy = false;
+        changed.notify_all();
+    }
+}
+
+bool BufferedFileWriter::close() {
+    if (!outfile.is_open())
+        return !failed;
+    flushChunk();
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        changed.notify_all();
+        worker.join();
+    }
+    outfile.close();
+    if (outfile.fail())
+        failed = true;
+    return !failed;
+}
@@ -0,0 +1,48 @@
+#ifndef BUFFERED_FILE_WRITER_H
+#define BUFFERED_FILE_WRITER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Collects small writes (one maze row at a time) into big chunks and hands
+// every full chunk to the file in a single write. With background on, the
+// chunk is written by an I/O thread while the caller fills the next one, so
+// formatting rows and waiting on the disk overlap.
+class BufferedFileWriter {
+public:
+    static const size_t chunkSize = size_t(4) << 20;
+
+    explicit BufferedFileWriter(const std::string& filename, bool background = true);
+    ~BufferedFileWriter();
+
+    BufferedFileWriter(const BufferedFileWriter&) = delete;
+    BufferedFileWriter& operator=(const BufferedFileWriter&) = delete;
+
+    bool isOpen() const;
+    void write(const char* data, size_t length);
+    void put(char c);
+    // Writes out whatever is left and waits for the I/O thread.
+    // Returns false if any write failed.
+    bool close();
+
+private:
+    std::ofstream outfile;
+    std::vector<char> filling;
+    std::vector<char> writing; // owned by the I/O thread while busy is set
+    bool background;
+    bool busy = false;
+    bool stopping = false;
+    bool failed = false;
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable changed;
+
+    void flushChunk();
+    void writeLoop();
+};
+
+#endif
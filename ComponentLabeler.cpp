@@ -0,0 +1,134 @@
+#include "ComponentLabeler.h"
+#include <thread>
+#include <algorithm>
+#include <climits>
+#include <iostream>
+
+// Union-find with path halving
+// Reference -> https://en.wikipedia.org/wiki/Disjoint-set_data_structure
+namespace {
+    int findRoot(std::vector<int>& parent, int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    void unite(std::vector<int>& parent, int a, int b) {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if (a == b)
+            return;
+        // always hang the larger index under the smaller one so roots stay stable
+        if (a < b)
+            parent[b] = a;
+        else
+            parent[a] = b;
+    }
+}
+
+ComponentLabeler::ComponentLabeler(const std::vector<std::string>& maze, int threads) {
+    rows = static_cast<int>(maze.size());
+    cols = rows > 0 ? static_cast<int>(maze[0].size()) : 0;
+    if (rows == 0 || cols == 0)
+        return;
+    // labels are cell indices, which have to fit in an int (and in the
+    // int32 ComponentLabels section of an index file)
+    if (static_cast<long long>(rows) * cols > maxCells) {
+        std::cerr << "The maze is too big to label (" << rows << " x " << cols
+                  << "), reachability will be found by searching instead" << std::endl;
+        rows = cols = 0;
+        return;
+    }
+
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::min(threads, rows);
+
+    std::vector<int> parent(static_cast<size_t>(rows) * cols, -1);
+
+    // Step 1: every thread labels its own band of rows. Bands never touch each
+    // other's cells here so there is nothing to lock.
+    int bandHeight = (rows + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (int begin = 0; begin < rows; begin += bandHeight) {
+        int end = std::min(rows, begin + bandHeight);
+        workers.emplace_back(&ComponentLabeler::labelBand, this, std::cref(maze), std::ref(parent), begin, end);
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    // Step 2: stitch bands together along their borders
+    for (int border = bandHeight; border < rows; border += bandHeight) {
+        for (int y = 0; y < cols; y++) {
+            if (maze[border - 1][y] == '.' && maze[border][y] == '.')
+                unite(parent, (border - 1) * cols + y, border * cols + y);
+        }
+    }
+
+    // Step 3: resolve every cell to its root. Roots are the smallest index of
+    // their component so they can be used as the label directly. A parent
+    // never has a larger index than its child, so one pass in index order
+    // finds every root, and it can be done in place instead of needing a
+    // second rows * cols array.
+    for (size_t i = 0; i < parent.size(); i++) {
+        if (parent[i] < 0)
+            continue;
+        if (parent[i] == static_cast<int>(i))
+            count++;
+        else
+            parent[i] = parent[parent[i]];
+    }
+    labels = std::move(parent);
+}
+
+ComponentLabeler::ComponentLabeler(const int* savedLabels, int rows, int cols, int count)
+    : rows(rows), cols(cols), count(count), saved(savedLabels) {}
+
+void ComponentLabeler::labelBand(const std::vector<std::string>& maze, std::vector<int>& parent, int rowBegin, int rowEnd) const {
+    for (int x = rowBegin; x < rowEnd; x++) {
+        for (int y = 0; y < cols; y++) {
+            if (maze[x][y] != '.')
+                continue;
+            int i = x * cols + y;
+            parent[i] = i;
+            // only look up and left, those cells were already visited
+            if (y > 0 && maze[x][y - 1] == '.')
+                unite(parent, i - 1, i);
+            if (x > rowBegin && maze[x - 1][y] == '.')
+                unite(parent, i - cols, i);
+        }
+    }
+}
+
+int ComponentLabeler::label(Point p) const {
+    if (p.first < 0 || p.second < 0 || p.first >= rows || p.second >= cols)
+        return -1;
+    return getLabels()[static_cast<size_t>(p.first) * cols + p.second];
+}
+
+bool ComponentLabeler::connected(Point a, Point b) const {
+    int la = label(a);
+    return la >= 0 && la == label(b);
+}
+
+int ComponentLabeler::componentCount() const {
+    return count;
+}
+
+bool ComponentLabeler::empty() const {
+    return labels.empty() && !saved;
+}
+
+const int* ComponentLabeler::getLabels() const {
+    return saved ? saved : labels.data();
+}
+
+int ComponentLabeler::getRows() const {
+    return rows;
+}
+
+int ComponentLabeler::getCols() const {
+    return cols;
+}
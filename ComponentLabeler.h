@@ -0,0 +1,43 @@
+#ifndef COMPONENT_LABELER_H
+#define COMPONENT_LABELER_H
+
+#include <vector>
+#include <string>
+
+// Labels every open cell of a maze with the id of its connected component so
+// reachability between two cells is a single comparison instead of a search.
+// Walls get the label -1.
+class ComponentLabeler {
+public:
+    using Point = std::pair<int, int>;
+
+    ComponentLabeler() = default;
+    // Labels are int cell indices, so bigger mazes are not labelled and
+    // the labeler stays empty
+    static constexpr long long maxCells = 0x7FFFFFFF;
+
+    // threads <= 0 means use std::thread::hardware_concurrency()
+    explicit ComponentLabeler(const std::vector<std::string>& maze, int threads = 0);
+    // Uses labels saved earlier (see MazeIndexFile.h) where they are, without
+    // copying. They have to outlive the labeler.
+    ComponentLabeler(const int* savedLabels, int rows, int cols, int count);
+
+    int label(Point p) const;
+    bool connected(Point a, Point b) const;
+    int componentCount() const;
+    bool empty() const;
+    // rows * cols labels, row by row, for saving
+    const int* getLabels() const;
+    int getRows() const;
+    int getCols() const;
+
+private:
+    int rows = 0, cols = 0;
+    int count = 0;
+    std::vector<int> labels;
+    const int* saved = nullptr;
+
+    void labelBand(const std::vector<std::string>& maze, std::vector<int>& parent, int rowBegin, int rowEnd) const;
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include "DeadEndFiller.h"
+#include <thread>
+#include <bitset>
+#include <algorithm>
+
+// Dead-end filling as described here
+// https://en.wikipedia.org/wiki/Maze-solving_algorithm#Dead-end_filling
+
+DeadEndFiller::DeadEndFiller(const std::vector<std::string>& maze, Point start, Point goal)
+    : grid(BitGrid::fromMaze(maze)), start(start), goal(goal) {}
+
+void DeadEndFiller::fill(int threads) {
+    int rows = grid.getRows();
+    int stride = grid.wordsPerRow();
+    filled = 0;
+    if (rows == 0 || stride == 0)
+        return;
+
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::min(threads, rows);
+    int bandHeight = (rows + threads - 1) / threads;
+    int bands = (rows + bandHeight - 1) / bandHeight;
+
+    std::vector<char> dirty(rows, 1);
+    std::vector<std::vector<uint64_t>> above(bands), below(bands);
+    std::vector<long long> bandFilled(bands, 0);
+    const std::vector<uint64_t> empty(stride, 0);
+
+    bool changed = true;
+    while (changed) {
+        // Each band only writes its own rows and sees its neighbours' border
+        // rows through a snapshot, so the threads never share a word.
+        for (int b = 0; b < bands; b++) {
+            int begin = b * bandHeight;
+            int end = std::min(rows, begin + bandHeight);
+            above[b] = begin > 0 ? std::vector<uint64_t>(grid.row(begin - 1), grid.row(begin - 1) + stride) : empty;
+            below[b] = end < rows ? std::vector<uint64_t>(grid.row(end), grid.row(end) + stride) : empty;
+        }
+
+        std::vector<std::thread> workers;
+        for (int b = 0; b < bands; b++) {
+            int begin = b * bandHeight;
+            int end = std::min(rows, begin + bandHeight);
+            workers.emplace_back(&DeadEndFiller::fillBand, this, begin, end, std::cref(above[b]), std::cref(below[b]),
+                                 std::ref(dirty), std::ref(bandFilled[b]));
+        }
+        for (auto& worker : workers)
+            worker.join();
+
+        // If a border row changed, the row on the other side of the border has
+        // to be looked at again in the next round
+        changed = false;
+        for (int b = 0; b < bands; b++) {
+            int begin = b * bandHeight;
+            int end = std::min(rows, begin + bandHeight);
+            if (begin > 0 && !std::equal(above[b].begin(), above[b].end(), grid.row(begin - 1))) {
+                dirty[begin] = 1;
+                changed = true;
+            }
+            if (end < rows && !std::equal(below[b].begin(), below[b].end(), grid.row(end))) {
+                dirty[end - 1] = 1;
+                changed = true;
+            }
+        }
+    }
+
+    for (long long n : bandFilled)
+        filled += n;
+}
+
+void DeadEndFiller::fillBand(int rowBegin, int rowEnd, const std::vector<uint64_t>& above, const std::vector<uint64_t>& below,
+                             std::vector<char>& dirty, long long& bandFilled) {
+    bool any = true;
+    while (any) {
+        any = false;
+        for (int r = rowBegin; r < rowEnd; r++) {
+            if (!dirty[r])
+                continue;
+            dirty[r] = 0;
+            const uint64_t* up = r == rowBegin ? above.data() : grid.row(r - 1);
+            const uint64_t* down = r == rowEnd - 1 ? below.data() : grid.row(r + 1);
+            if (updateRow(r, up, down, bandFilled)) {
+                // filling a cell can create new dead ends next to it
+                dirty[r] = 1;
+                if (r > rowBegin)
+                    dirty[r - 1] = 1;
+                if (r + 1 < rowEnd)
+                    dirty[r + 1] = 1;
+                any = true;
+            }
+        }
+    }
+}
+
+// One automaton step for a whole row: a cell stays open only if at least two
+// of its four neighbours are open, or if it is the start or the goal.
+bool DeadEndFiller::updateRow(int r, const uint64_t* above, const uint64_t* below, long long& bandFilled) {
+    uint64_t* cur = grid.row(r);
+    int stride = grid.wordsPerRow();
+    bool changed = false;
+
+    for (int w = 0; w < stride; w++) {
+        uint64_t cell = cur[w];
+        if (cell == 0)
+            continue;
+
+        uint64_t up = above[w];
+        uint64_t down = below[w];
+        // neighbour to the left of column c is column c - 1, so shift it up one bit
+        uint64_t left = (cell << 1) | (w > 0 ? cur[w - 1] >> 63 : 0);
+        uint64_t right = (cell >> 1) | (w + 1 < stride ? cur[w + 1] << 63 : 0);
+
+        uint64_t atLeastTwo = (up & down) | ((up | down) & (left | right)) | (left & right);
+
+        uint64_t keep = 0;
+        if (start.first == r && (start.second >> 6) == w)
+            keep |= uint64_t(1) << (start.second & 63);
+        if (goal.first == r && (goal.second >> 6) == w)
+            keep |= uint64_t(1) << (goal.second & 63);
+
+        uint64_t next = cell & (atLeastTwo | keep);
+        if (next != cell) {
+            bandFilled += static_cast<long long>(std::bitset<64>(cell & ~next).count());
+            cur[w] = next;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+std::vector<std::string> DeadEndFiller::getMaze() const {
+    return grid.toMaze();
+}
+
+const BitGrid& DeadEndFiller::getGrid() const {
+    return grid;
+}
+
+long long DeadEndFiller::getFilledCount() const {
+    return filled;
+}
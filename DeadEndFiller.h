@@ -0,0 +1,39 @@
+#ifndef DEAD_END_FILLER_H
+#define DEAD_END_FILLER_H
+
+#include <vector>
+#include <string>
+#include "BitGrid.h"
+
+// Dead-end filling preprocessor. Repeatedly walls off every open cell with at
+// most one open neighbour (except start and goal) until nothing changes. What
+// is left are the corridors that lie on some start-goal route, plus any loops.
+// For a perfect maze that is exactly the solution path.
+//
+// The grid is packed 64 cells per word and each step is a cellular automaton
+// rule evaluated a whole word at a time. Row bands are filled on separate
+// threads and re-synchronised along their borders until the grid is stable.
+class DeadEndFiller {
+public:
+    using Point = std::pair<int, int>;
+
+    DeadEndFiller(const std::vector<std::string>& maze, Point start, Point goal);
+
+    // threads <= 0 means use std::thread::hardware_concurrency()
+    void fill(int threads = 0);
+
+    std::vector<std::string> getMaze() const;
+    const BitGrid& getGrid() const;
+    long long getFilledCount() const;
+
+private:
+    BitGrid grid;
+    Point start, goal;
+    long long filled = 0;
+
+    void fillBand(int rowBegin, int rowEnd, const std::vector<uint64_t>& above, const std::vector<uint64_t>& below,
+                  std::vector<char>& dirty, long long& bandFilled);
+    bool updateRow(int r, const uint64_t* above, const uint64_t* below, long long& bandFilled);
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef DISJOINT_SET_H
+#define DISJOINT_SET_H
+
+#include <vector>
+#include <numeric>
+
+// Union-find with path halving and union by size
+// Reference -> https://en.wikipedia.org/wiki/Disjoint-set_data_structure
+class DisjointSet {
+public:
+    explicit DisjointSet(size_t count) : parent(count), size(count, 1) {
+        std::iota(parent.begin(), parent.end(), size_t(0));
+    }
+
+    size_t find(size_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    // returns false if a and b were already in the same set
+    bool unite(size_t a, size_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b)
+            return false;
+        if (size[a] < size[b])
+            std::swap(a, b);
+        parent[b] = a;
+        size[a] += size[b];
+        return true;
+    }
+
+private:
+    std::vector<size_t> parent;
+    std::vector<size_t> size;
+};
+
+#endif
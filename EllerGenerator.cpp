@@ -0,0 +1,149 @@
+#include "EllerGenerator.h"
+#include <algorithm>
+#include <iostream>
+
+EllerGenerator::EllerGenerator(long long intRows, int intCols, uint64_t intSeed) : rows(intRows), cols(intCols), seed(intSeed) {
+    if (rows % 2 == 0)
+        rows += 1;
+    if (cols % 2 == 0)
+        cols += 1;
+    // line[1] and line[cols - 2] are the entry and exit
+    if (rows < 3 || cols < 3) {
+        std::cerr << "A maze needs at least 3 x 3 characters, not " << intRows << " x " << intCols << std::endl;
+        tooSmall = true;
+    }
+}
+
+int EllerGenerator::findSet(int id) {
+    while (parent[id] != id) {
+        parent[id] = parent[parent[id]];
+        id = parent[id];
+    }
+    return id;
+}
+
+bool EllerGenerator::generate(RowSink& sink) {
+    if (tooSmall)
+        return false;
+    long long cellRows = rows / 2;
+    int width = cols / 2;
+    Rng rng(seed);
+
+    // coin flips are taken 64 at a time from one random word
+    uint64_t bits = 0;
+    int bitsLeft = 0;
+    auto coin = [&]() {
+        if (bitsLeft == 0) {
+            bits = rng.next();
+            bitsLeft = 64;
+        }
+        bitsLeft--;
+        bool heads = bits & 1;
+        bits >>= 1;
+        return heads;
+    };
+
+    std::string line(cols, '#');
+    line[1] = '.';  // Entry point
+    sink.consumeRow(line);
+
+    set.resize(width);
+    parent.resize(width);
+    members.assign(width, 0);
+    chosen.assign(width, 0);
+    goesDown.assign(width, 0);
+    down.assign(width, 0);
+    used.assign(width, 0);
+
+    // first row: every cell in its own set
+    for (int j = 0; j < width; j++)
+        set[j] = j;
+
+    for (long long i = 0; i < cellRows; i++) {
+        bool lastRow = i == cellRows - 1;
+
+        // Step 1: randomly join neighbouring cells that are in different sets.
+        // The last row joins all of them so everything ends up connected.
+        for (int j = 0; j < width; j++)
+            parent[set[j]] = set[j];
+
+        std::fill(line.begin(), line.end(), '#');
+        for (int j = 0; j < width; j++) {
+            line[2 * j + 1] = '.';
+            if (j + 1 == width)
+                break;
+            int a = findSet(set[j]);
+            int b = findSet(set[j + 1]);
+            if (a != b && (lastRow || coin())) {
+                parent[b] = a;
+                line[2 * j + 2] = '.';
+            }
+        }
+        for (int j = 0; j < width; j++)
+            set[j] = findSet(set[j]);
+        sink.consumeRow(line);
+
+        std::fill(line.begin(), line.end(), '#');
+        if (lastRow) {
+            line[cols - 2] = '.';  // Exit
+            sink.consumeRow(line);
+            return true;
+        }
+
+        // Step 2: every set opens at least one passage down. Each cell goes
+        // down with probability 1/2, and one member per set is picked by
+        // reservoir sampling in case none of them did.
+        for (int j = 0; j < width; j++) {
+            members[set[j]] = 0;
+            goesDown[set[j]] = 0;
+        }
+        for (int j = 0; j < width; j++) {
+            int s = set[j];
+            members[s]++;
+            if (members[s] == 1 || rng.bounded(members[s]) == 0)
+                chosen[s] = j;
+            down[j] = coin();
+            if (down[j])
+                goesDown[s] = 1;
+        }
+        for (int j = 0; j < width; j++) {
+            int s = set[j];
+            if (!goesDown[s] && chosen[s] == j)
+                down[j] = 1;
+        }
+
+        // Step 3: cells below a passage keep their set, the rest get a fresh
+        // id that no cell is using, which keeps ids below width forever
+        std::fill(used.begin(), used.end(), 0);
+        for (int j = 0; j < width; j++) {
+            if (down[j]) {
+                line[2 * j + 1] = '.';
+                used[set[j]] = 1;
+            }
+        }
+        sink.consumeRow(line);
+
+        int freeId = 0;
+        for (int j = 0; j < width; j++) {
+            if (down[j])
+                continue;
+            while (used[freeId])
+                freeId++;
+            set[j] = freeId;
+            used[freeId] = 1;
+        }
+    }
+    return true;
+}
+
+long long EllerGenerator::getRows() const {
+    return rows;
+}
+
+int EllerGenerator::getCols() const {
+    return cols;
+}
+
+uint64_t EllerGenerator::getSeed() const {
+    return seed;
+}
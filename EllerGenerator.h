@@ -0,0 +1,47 @@
+#ifndef ELLER_GENERATOR_H
+#define ELLER_GENERATOR_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Rng.h"
+#include "RowSink.h"
+
+// Eller's algorithm: builds a perfect maze one row at a time and only ever
+// remembers which set each cell of the current row belongs to, so memory is
+// O(cols) no matter how many rows are generated. Rows go straight to a
+// RowSink in the same 2x+1 character layout MazeGenerator uses, with the
+// entry at (0, 1) and the exit at (rows - 1, cols - 2).
+// Reference -> http://www.neocomputer.org/projects/eller.html
+class EllerGenerator {
+public:
+    // Even sizes are rounded up like MazeGenerator does. Anything under
+    // 3 x 3 has no room for the entry and exit: that is printed here and
+    // generate() refuses to run.
+    EllerGenerator(long long rows, int cols, uint64_t seed = Rng::randomSeed());
+    // Returns false if the size was too small
+    bool generate(RowSink& sink);
+
+    long long getRows() const;
+    int getCols() const;
+    uint64_t getSeed() const;
+
+private:
+    long long rows;
+    int cols;
+    uint64_t seed;
+    bool tooSmall = false;
+
+    // per-row state, all sized to the number of cells in a row
+    std::vector<int> set;       // set id of every cell, ids are in [0, width)
+    std::vector<int> parent;    // union-find over set ids while merging
+    std::vector<int> members;   // cells seen per set when choosing down passages
+    std::vector<int> chosen;    // fallback cell that opens down for each set
+    std::vector<char> goesDown; // whether any cell of a set opened down
+    std::vector<char> down;     // south passage of every cell
+    std::vector<char> used;     // set ids still in use for the next row
+
+    int findSet(int id);
+};
+
+#endif
@@ -0,0 +1,14 @@
+#include "GridLayout.h"
+
+GridLayout::GridLayout(int intRows, int intCols, CellOrder cellOrder) : rows(intRows), cols(intCols), order(cellOrder) {
+    switch (order) {
+    case CellOrder::Tiled:
+        blocksPerRow = (cols + 7) / 8;
+        slots = static_cast<size_t>((rows + 7) / 8) * blocksPerRow * 64;
+        break;
+    default:
+        blocksPerRow = 0;
+        slots = static_cast<size_t>(rows) * cols;
+        break;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef GRID_LAYOUT_H
+#define GRID_LAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+
+// How a solver lays out per-cell arrays in memory.
+//  RowMajor: index = r * cols + c. Going up or down jumps a whole row.
+//  Tiled:    8x8 tiles stored one after another, row-major inside a tile, so
+//            most vertical neighbours sit in the same or an adjacent cache line.
+enum class CellOrder { RowMajor, Tiled };
+
+class GridLayout {
+public:
+    GridLayout() = default;
+    GridLayout(int rows, int cols, CellOrder order = CellOrder::RowMajor);
+
+    size_t index(int r, int c) const {
+        switch (order) {
+        case CellOrder::Tiled:
+            return ((static_cast<size_t>(r >> 3) * blocksPerRow + (c >> 3)) << 6) | ((r & 7) << 3) | (c & 7);
+        default:
+            return static_cast<size_t>(r) * cols + c;
+        }
+    }
+
+    // number of slots a per-cell array needs, including tile padding
+    size_t size() const { return slots; }
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    CellOrder getOrder() const { return order; }
+
+private:
+    int rows = 0, cols = 0;
+    CellOrder order = CellOrder::RowMajor;
+    size_t blocksPerRow = 0;
+    size_t slots = 0;
+};
+
+#endif
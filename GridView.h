@@ -0,0 +1,39 @@
+#ifndef GRID_VIEW_H
+#define GRID_VIEW_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read-only view of a character maze that lives somewhere else, usually a
+// memory-mapped file. Row r starts stride bytes after row r - 1, so the line
+// endings of the file are simply stepped over and nothing gets copied.
+// view[r][c] works just like it does on a std::vector<std::string>.
+class GridView {
+public:
+    GridView() = default;
+    GridView(const char* data, int rows, int cols, size_t stride)
+        : data(data), rows(rows), cols(cols), stride(stride) {}
+
+    const char* operator[](int r) const { return data + static_cast<size_t>(r) * stride; }
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    bool empty() const { return rows == 0 || cols == 0; }
+
+    // Owned copy, for code that still wants strings (the renderer)
+    std::vector<std::string> toMaze() const {
+        std::vector<std::string> maze;
+        maze.reserve(rows);
+        for (int r = 0; r < rows; r++)
+            maze.emplace_back((*this)[r], cols);
+        return maze;
+    }
+
+private:
+    const char* data = nullptr;
+    int rows = 0, cols = 0;
+    size_t stride = 0;
+};
+
+#endif
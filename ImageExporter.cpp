@@ -0,0 +1,369 @@
+#include "ImageExporter.h"
+#include "BufferedFileWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <thread>
+
+namespace {
+    // CRC-32 as PNG chunks use it
+    // Reference -> https://www.w3.org/TR/png/#D-CRCAppendix
+    struct CrcTable {
+        uint32_t entries[256];
+        CrcTable() {
+            for (uint32_t n = 0; n < 256; n++) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                entries[n] = c;
+            }
+        }
+    };
+    const CrcTable crcTable;
+
+    uint32_t crc32(const uint8_t* bytes, size_t length, uint32_t crc = 0) {
+        crc = ~crc;
+        for (size_t i = 0; i < length; i++)
+            crc = crcTable.entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    // Adler-32, the checksum at the end of a zlib stream
+    // Reference -> https://www.rfc-editor.org/rfc/rfc1950
+    const uint32_t adlerBase = 65521;
+
+    uint32_t adler32(const uint8_t* bytes, size_t length) {
+        uint32_t a = 1, b = 0;
+        while (length > 0) {
+            // 5552 is the most bytes that can be summed before b overflows
+            size_t block = std::min<size_t>(length, 5552);
+            for (size_t i = 0; i < block; i++) {
+                a += bytes[i];
+                b += a;
+            }
+            a %= adlerBase;
+            b %= adlerBase;
+            bytes += block;
+            length -= block;
+        }
+        return (b << 16) | a;
+    }
+
+    // Checksum of first + second from the checksums of both halves, so every
+    // band can work out its own
+    uint32_t adler32Combine(uint32_t first, uint32_t second, uint64_t secondLength) {
+        uint64_t a1 = first & 0xFFFF, b1 = first >> 16;
+        uint64_t a2 = second & 0xFFFF, b2 = second >> 16;
+        uint64_t a = (a1 + a2 + adlerBase - 1) % adlerBase;
+        uint64_t b = (b1 + b2 + (secondLength % adlerBase) * ((a1 + adlerBase - 1) % adlerBase)) % adlerBase;
+        return static_cast<uint32_t>((b << 16) | a);
+    }
+
+    // Deflate writes bits from the lowest bit of each byte up
+    class BitWriter {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& out) : out(out) {}
+
+        void bits(uint32_t value, int count) {
+            buffer |= static_cast<uint64_t>(value) << used;
+            used += count;
+            while (used >= 8) {
+                out.push_back(static_cast<uint8_t>(buffer));
+                buffer >>= 8;
+                used -= 8;
+            }
+        }
+
+        // Huffman codes go in starting from their most significant bit
+        void code(uint32_t value, int length) {
+            uint32_t reversed = 0;
+            for (int i = 0; i < length; i++)
+                reversed |= ((value >> i) & 1) << (length - 1 - i);
+            bits(reversed, length);
+        }
+
+        void align() {
+            if (used > 0)
+                bits(0, 8 - used);
+        }
+
+    private:
+        std::vector<uint8_t>& out;
+        uint64_t buffer = 0;
+        int used = 0;
+    };
+
+    // Fixed Huffman code for literal / length symbol 0..287 (RFC 1951 3.2.6)
+    void writeSymbol(BitWriter& writer, int symbol) {
+        if (symbol < 144)
+            writer.code(0x30 + symbol, 8);
+        else if (symbol < 256)
+            writer.code(0x190 + symbol - 144, 9);
+        else if (symbol < 280)
+            writer.code(symbol - 256, 7);
+        else
+            writer.code(0xC0 + symbol - 280, 8);
+    }
+
+    const int lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const int lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const int distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                   257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const int distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    void writeMatch(BitWriter& writer, int length, int distance) {
+        int l = 28;
+        while (lengthBase[l] > length)
+            l--;
+        writeSymbol(writer, 257 + l);
+        writer.bits(length - lengthBase[l], lengthExtra[l]);
+        int d = 29;
+        while (distanceBase[d] > distance)
+            d--;
+        writer.code(d, 5);
+        writer.bits(distance - distanceBase[d], distanceExtra[d]);
+    }
+
+    // One non-final fixed Huffman block for a band, followed by an empty
+    // stored block to get back onto a byte boundary. Matches only look at
+    // the previous byte (runs) and the byte one scanline up, which is where
+    // nearly all the redundancy in a maze image is, and never reach outside
+    // the band.
+    void deflateBand(const std::vector<uint8_t>& data, size_t stride, std::vector<uint8_t>& out) {
+        BitWriter writer(out);
+        writer.bits(0, 1); // not the last block
+        writer.bits(1, 2); // fixed Huffman codes
+        bool useUp = stride <= 32768;
+        size_t n = data.size();
+        size_t i = 0;
+        while (i < n) {
+            size_t limit = std::min<size_t>(258, n - i);
+            size_t run = 0, up = 0;
+            if (i >= 1)
+                while (run < limit && data[i + run] == data[i + run - 1])
+                    run++;
+            if (useUp && i >= stride)
+                while (up < limit && data[i + up] == data[i + up - stride])
+                    up++;
+            size_t length = std::max(run, up);
+            if (length >= 3) {
+                writeMatch(writer, static_cast<int>(length), run >= up ? 1 : static_cast<int>(stride));
+                i += length;
+            }
+            else {
+                writeSymbol(writer, data[i]);
+                i++;
+            }
+        }
+        writeSymbol(writer, 256); // end of block
+        writer.bits(0, 1);
+        writer.bits(0, 2); // stored
+        writer.align();
+        const uint8_t empty[4] = { 0x00, 0x00, 0xFF, 0xFF };
+        out.insert(out.end(), empty, empty + 4);
+    }
+
+    void putBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+
+    // length, type, data, CRC of type + data
+    void writeChunk(BufferedFileWriter& file, const char* type, const std::vector<uint8_t>& body, uint32_t bodyCrc) {
+        std::vector<uint8_t> head;
+        putBigEndian(head, static_cast<uint32_t>(body.size()));
+        head.insert(head.end(), type, type + 4);
+        file.write(reinterpret_cast<const char*>(head.data()), head.size());
+        file.write(reinterpret_cast<const char*>(body.data()), body.size());
+        std::vector<uint8_t> tail;
+        putBigEndian(tail, bodyCrc);
+        file.write(reinterpret_cast<const char*>(tail.data()), tail.size());
+    }
+
+    uint32_t chunkCrc(const char* type, const std::vector<uint8_t>& body) {
+        return crc32(body.data(), body.size(), crc32(reinterpret_cast<const uint8_t*>(type), 4));
+    }
+
+    void writeChunk(BufferedFileWriter& file, const char* type, const std::vector<uint8_t>& body) {
+        writeChunk(file, type, body, chunkCrc(type, body));
+    }
+}
+
+ImageExporter::ImageExporter(const std::vector<std::string>& maze) : ImageExporter(BitGrid::fromMaze(maze)) {}
+
+ImageExporter::ImageExporter(BitGrid grid) : maze(std::move(grid)) {}
+
+void ImageExporter::setScale(int pixels) {
+    scale = std::max(1, pixels);
+}
+
+void ImageExporter::setThreads(int newThreads) {
+    threads = newThreads;
+}
+
+void ImageExporter::mark(BitGrid& overlay, const std::vector<Point>& points) const {
+    overlay = BitGrid(maze.getRows(), maze.getCols());
+    for (const auto& p : points) {
+        if (p.first >= 0 && p.second >= 0 && p.first < maze.getRows() && p.second < maze.getCols())
+            overlay.set(p.first, p.second, true);
+    }
+}
+
+void ImageExporter::setVisited(const std::vector<Point>& points, Color color) {
+    mark(visited, points);
+    palette[2] = color;
+}
+
+void ImageExporter::setPath(const std::vector<Point>& points, Color color) {
+    mark(path, points);
+    palette[3] = color;
+}
+
+ImageExporter::Format ImageExporter::formatFor(const std::string& filename) {
+    std::string ending = filename.size() >= 4 ? filename.substr(filename.size() - 4) : "";
+    std::transform(ending.begin(), ending.end(), ending.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ending == ".ppm" ? Format::PPM : Format::PNG;
+}
+
+long long ImageExporter::width() const {
+    return static_cast<long long>(maze.getCols()) * scale;
+}
+
+long long ImageExporter::height() const {
+    return static_cast<long long>(maze.getRows()) * scale;
+}
+
+void ImageExporter::drawRow(int y, uint8_t* out) const {
+    int r = y / scale;
+    bool hasVisited = visited.getRows() > 0, hasPath = path.getRows() > 0;
+    for (int c = 0; c < maze.getCols(); c++) {
+        uint8_t index = maze.get(r, c) ? 1 : 0;
+        if (hasVisited && visited.get(r, c))
+            index = 2;
+        if (hasPath && path.get(r, c))
+            index = 3;
+        std::fill(out + static_cast<size_t>(c) * scale, out + static_cast<size_t>(c + 1) * scale, index);
+    }
+}
+
+bool ImageExporter::write(const std::string& filename, Format format) const {
+    long long w = width(), h = height();
+    if (w <= 0 || h <= 0) {
+        std::cerr << "Nothing to export to " << filename << std::endl;
+        return false;
+    }
+    // PNG stores both sides in 31 bits, and a PPM row has to fit an int too
+    if (w > 0x7FFFFFFF / 3 || h > 0x7FFFFFFF) {
+        std::cerr << "The image for " << filename << " would be " << w << " x " << h << " pixels, which is too big, try a smaller scale" << std::endl;
+        return false;
+    }
+    BufferedFileWriter file(filename);
+    if (!file.isOpen())
+        return false;
+
+    // about 4 MB of pixels per band
+    int bandRows = static_cast<int>(std::max<long long>(1, (4 << 20) / (w * 3)));
+    int bands = static_cast<int>((h + bandRows - 1) / bandRows);
+    int workers = threads > 0 ? threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    workers = std::max(1, std::min(workers, bands));
+
+    // PNG scanlines are a filter type byte (0 = none) and then 2 bits per
+    // pixel, leftmost pixel in the high bits
+    size_t stride = format == Format::PNG ? (static_cast<size_t>(w) + 3) / 4 + 1 : static_cast<size_t>(w) * 3;
+    std::vector<std::vector<uint8_t>> output(workers);
+    std::vector<uint32_t> crcs(workers), adlers(workers);
+    std::vector<size_t> rawSizes(workers);
+
+    auto makeBand = [&](int band, int slot) {
+        int first = band * bandRows;
+        int last = static_cast<int>(std::min<long long>(h, first + static_cast<long long>(bandRows)));
+        std::vector<uint8_t> raw(static_cast<size_t>(last - first) * stride);
+        std::vector<uint8_t> indices(static_cast<size_t>(w));
+        for (int y = first; y < last; y++) {
+            uint8_t* line = raw.data() + static_cast<size_t>(y - first) * stride;
+            drawRow(y, indices.data());
+            if (format == Format::PNG) {
+                line[0] = 0;
+                for (long long x = 0; x < w; x++)
+                    line[1 + x / 4] |= static_cast<uint8_t>(indices[x] << (6 - 2 * (x & 3)));
+                continue;
+            }
+            for (long long x = 0; x < w; x++) {
+                const Color& color = palette[indices[x]];
+                line[3 * x] = color.r;
+                line[3 * x + 1] = color.g;
+                line[3 * x + 2] = color.b;
+            }
+        }
+        if (format == Format::PPM) {
+            output[slot].swap(raw);
+            return;
+        }
+        output[slot].clear();
+        deflateBand(raw, stride, output[slot]);
+        crcs[slot] = chunkCrc("IDAT", output[slot]);
+        adlers[slot] = adler32(raw.data(), raw.size());
+        rawSizes[slot] = raw.size();
+    };
+
+    uint32_t adler = 1;
+    if (format == Format::PPM) {
+        std::string header = "P6\n" + std::to_string(w) + " " + std::to_string(h) + "\n255\n";
+        file.write(header.data(), header.size());
+    }
+    else {
+        const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+        std::vector<uint8_t> ihdr;
+        putBigEndian(ihdr, static_cast<uint32_t>(w));
+        putBigEndian(ihdr, static_cast<uint32_t>(h));
+        // 2 bit palette indices, no interlacing
+        const uint8_t rest[5] = { 2, 3, 0, 0, 0 };
+        ihdr.insert(ihdr.end(), rest, rest + 5);
+        writeChunk(file, "IHDR", ihdr);
+        std::vector<uint8_t> plte;
+        for (const Color& color : palette) {
+            plte.push_back(color.r);
+            plte.push_back(color.g);
+            plte.push_back(color.b);
+        }
+        writeChunk(file, "PLTE", plte);
+        // zlib header: deflate, 32K window, no dictionary
+        writeChunk(file, "IDAT", { 0x78, 0x01 });
+    }
+
+    // a handful of bands at a time, written out in order before the next lot
+    for (int start = 0; start < bands; start += workers) {
+        int count = std::min(workers, bands - start);
+        std::vector<std::thread> pool;
+        for (int i = 0; i < count; i++)
+            pool.emplace_back(makeBand, start + i, i);
+        for (auto& t : pool)
+            t.join();
+        for (int i = 0; i < count; i++) {
+            if (format == Format::PPM) {
+                file.write(reinterpret_cast<const char*>(output[i].data()), output[i].size());
+                continue;
+            }
+            writeChunk(file, "IDAT", output[i], crcs[i]);
+            adler = adler32Combine(adler, adlers[i], rawSizes[i]);
+        }
+    }
+
+    if (format == Format::PNG) {
+        // empty final stored block, then the checksum of all scanlines
+        std::vector<uint8_t> end = { 0x01, 0x00, 0x00, 0xFF, 0xFF };
+        putBigEndian(end, adler);
+        writeChunk(file, "IDAT", end);
+        writeChunk(file, "IEND", {});
+    }
+
+    if (!file.close()) {
+        std::cerr << "Something went wrong writing " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
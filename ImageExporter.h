@@ -0,0 +1,69 @@
+#ifndef IMAGE_EXPORTER_H
+#define IMAGE_EXPORTER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "BitGrid.h"
+
+// Writes a maze, and optionally a solver's visited cells and path, to an
+// image file without a window, for servers with no display.
+//
+// The image is never held in memory as a whole. It is produced in bands of
+// rows: each thread draws and compresses one band, and the bands are written
+// out in order before the next lot starts. A 20k x 20k maze only ever needs
+// the maze and overlay bits (1 bit per cell each) plus a few bands.
+//
+//  PPM: binary P6, plain RGB, readable by nearly everything.
+//       Reference -> https://netpbm.sourceforge.net/doc/ppm.html
+//  PNG: 4-colour palette image, 2 bits per pixel, deflate done here with no
+//       zlib. Every band is compressed on its own (runs and repeats of the
+//       row above, fixed Huffman codes) and ends in an empty stored block,
+//       so the bands line up on byte boundaries and can simply be written
+//       one after another, each as its own IDAT chunk.
+//       Reference -> https://www.w3.org/TR/png/
+//       Reference -> https://www.rfc-editor.org/rfc/rfc1951
+class ImageExporter {
+public:
+    using Point = std::pair<int, int>;
+    enum class Format { PPM, PNG };
+
+    struct Color {
+        uint8_t r, g, b;
+    };
+
+    explicit ImageExporter(const std::vector<std::string>& maze);
+    explicit ImageExporter(BitGrid maze);
+
+    // pixels per maze character, 1 by default
+    void setScale(int pixels);
+    // threads <= 0 means use std::thread::hardware_concurrency()
+    void setThreads(int threads);
+
+    // Same colours as the window unless told otherwise
+    void setVisited(const std::vector<Point>& points, Color color = { 255, 100, 100 });
+    void setPath(const std::vector<Point>& points, Color color = { 0, 255, 0 });
+
+    // PNG unless the file name ends in .ppm
+    static Format formatFor(const std::string& filename);
+    // Prints what went wrong and returns false if the file could not be written
+    bool write(const std::string& filename, Format format) const;
+
+private:
+    BitGrid maze;
+    BitGrid visited;
+    BitGrid path;
+    // wall, open, visited, path
+    Color palette[4] = { { 0, 0, 0 }, { 255, 255, 255 }, { 255, 100, 100 }, { 0, 255, 0 } };
+    int scale = 1;
+    int threads = 0;
+
+    // long long, a big maze times a big scale does not fit in an int
+    long long width() const;
+    long long height() const;
+    // palette index of every pixel of image row y
+    void drawRow(int y, uint8_t* out) const;
+    void mark(BitGrid& overlay, const std::vector<Point>& points) const;
+};
+
+#endif
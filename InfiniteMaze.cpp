@@ -0,0 +1,201 @@
+#include "InfiniteMaze.h"
+#include "Passages.h"
+#include "Rng.h"
+#include <map>
+
+static_assert(InfiniteMaze::blockSide == 64, "a Sidewinder row is one 64 bit word");
+
+namespace {
+    // keeps the different hashes of one block apart
+    enum SaltKind : uint64_t { RunSalt, PickSalt, TurnSalt, EastDoorSalt, SouthDoorSalt };
+
+    uint64_t salt(SaltKind kind, int level, int y) {
+        return static_cast<uint64_t>(kind) << 16 | static_cast<uint64_t>(level) << 8 | static_cast<uint64_t>(y);
+    }
+}
+
+InfiniteMaze::InfiniteMaze(uint64_t seed) : seed(seed) {}
+
+uint64_t InfiniteMaze::getSeed() const {
+    return seed;
+}
+
+uint64_t InfiniteMaze::hash(int64_t row, int64_t col, uint64_t salt) const {
+    return Rng::mix(Rng::mix(seed ^ salt, static_cast<uint64_t>(row)), static_cast<uint64_t>(col));
+}
+
+InfiniteMaze::SidewinderRow InfiniteMaze::sidewinderRow(int level, int64_t blockRow, int64_t blockCol, int y) const {
+    SidewinderRow bits;
+    const uint64_t lastBit = uint64_t(1) << (blockSide - 1);
+    if (y == 0) {
+        bits.east = ~lastBit;  // the top row is one long corridor
+        return bits;
+    }
+    // 64 coin flips in one hash, with the last child always closing its run
+    bits.east = hash(blockRow, blockCol, salt(RunSalt, level, y)) & ~lastBit;
+    uint64_t picks = hash(blockRow, blockCol, salt(PickSalt, level, y));
+    int start = 0;
+    for (int x = 0; x < blockSide; x++) {
+        if ((bits.east >> x) & 1)
+            continue;
+        // run [start, x] closes here, one random member of it opens north
+        uint64_t length = static_cast<uint64_t>(x - start + 1);
+        uint64_t pick = ((Rng::mix(picks, static_cast<uint64_t>(start)) >> 32) * length) >> 32;
+        bits.north |= uint64_t(1) << (start + pick);
+        start = x + 1;
+    }
+    return bits;
+}
+
+uint8_t InfiniteMaze::childPassages(int level, int64_t blockRow, int64_t blockCol, int i, int j) const {
+    int turn = turnOf(level, blockRow, blockCol);
+    int y, x;
+    untwist(turn, i, j, y, x);
+    SidewinderRow here = sidewinderRow(level, blockRow, blockCol, y);
+    uint64_t below = y < blockSide - 1 ? sidewinderRow(level, blockRow, blockCol, y + 1).north : 0;
+    return twistedMask(turn, here, below, x);
+}
+
+void InfiniteMaze::blockPassages(int level, int64_t blockRow, int64_t blockCol, uint8_t* out) const {
+    int turn = turnOf(level, blockRow, blockCol);
+    SidewinderRow rows[blockSide];
+    for (int y = 0; y < blockSide; y++)
+        rows[y] = sidewinderRow(level, blockRow, blockCol, y);
+    for (int i = 0; i < blockSide; i++) {
+        for (int j = 0; j < blockSide; j++) {
+            int y, x;
+            untwist(turn, i, j, y, x);
+            out[i * blockSide + j] = twistedMask(turn, rows[y], y < blockSide - 1 ? rows[y + 1].north : 0, x);
+        }
+    }
+}
+
+int InfiniteMaze::turnOf(int level, int64_t blockRow, int64_t blockCol) const {
+    return static_cast<int>(hash(blockRow, blockCol, salt(TurnSalt, level, 0)) & 3);
+}
+
+// Where child (i, j) sits in the Sidewinder maze before it is turned so its
+// corridor runs along the north, south, west or east side
+void InfiniteMaze::untwist(int turn, int i, int j, int& y, int& x) {
+    const int last = blockSide - 1;
+    y = turn == 0 ? i : turn == 1 ? last - i : turn == 2 ? j : last - j;
+    x = turn < 2 ? j : i;
+}
+
+// Mask of child x of Sidewinder row here, below being the next row's north bits
+uint8_t InfiniteMaze::twistedMask(int turn, const SidewinderRow& here, uint64_t below, int x) {
+    // what North, South, West and East of the Sidewinder maze become once it is turned
+    static const uint8_t turned[4][4] = {
+        { North, South, West, East },
+        { South, North, West, East },
+        { West, East, North, South },
+        { East, West, North, South }
+    };
+    uint8_t mask = 0;
+    if ((here.north >> x) & 1)
+        mask |= turned[turn][0];
+    if ((below >> x) & 1)
+        mask |= turned[turn][1];
+    if (x > 0 && ((here.east >> (x - 1)) & 1))
+        mask |= turned[turn][2];
+    if ((here.east >> x) & 1)
+        mask |= turned[turn][3];
+    return mask;
+}
+
+// The smallest block holding both cells decides: they are in two of its
+// children, which have to be joined in its maze, and if those children are
+// blocks themselves the door between them has to be at this row.
+bool InfiniteMaze::opensEast(int64_t row, int64_t col) const {
+    if (row < 0 || col < 0 || row >= side || col + 1 >= side)
+        return false;
+    int level = 1;
+    while ((col >> (blockBits * level)) != ((col + 1) >> (blockBits * level)))
+        level++;
+    int childBits = blockBits * (level - 1);
+    int i = static_cast<int>((row >> childBits) & (blockSide - 1));
+    int j = static_cast<int>((col >> childBits) & (blockSide - 1));
+    if (!(childPassages(level, row >> (blockBits * level), col >> (blockBits * level), i, j) & East))
+        return false;
+    int64_t childSide = int64_t(1) << childBits;
+    uint64_t door = hash(row >> childBits, col >> childBits, salt(EastDoorSalt, level, 0));
+    return (row & (childSide - 1)) == static_cast<int64_t>(door & static_cast<uint64_t>(childSide - 1));
+}
+
+// Same as opensEast, with rows and columns swapped
+bool InfiniteMaze::opensSouth(int64_t row, int64_t col) const {
+    if (row < 0 || col < 0 || row + 1 >= side || col >= side)
+        return false;
+    int level = 1;
+    while ((row >> (blockBits * level)) != ((row + 1) >> (blockBits * level)))
+        level++;
+    int childBits = blockBits * (level - 1);
+    int i = static_cast<int>((row >> childBits) & (blockSide - 1));
+    int j = static_cast<int>((col >> childBits) & (blockSide - 1));
+    if (!(childPassages(level, row >> (blockBits * level), col >> (blockBits * level), i, j) & South))
+        return false;
+    int64_t childSide = int64_t(1) << childBits;
+    uint64_t door = hash(row >> childBits, col >> childBits, salt(SouthDoorSalt, level, 0));
+    return (col & (childSide - 1)) == static_cast<int64_t>(door & static_cast<uint64_t>(childSide - 1));
+}
+
+uint8_t InfiniteMaze::passages(int64_t cellRow, int64_t cellCol) const {
+    if (cellRow < 0 || cellCol < 0 || cellRow >= side || cellCol >= side)
+        return 0;
+    uint8_t mask = 0;
+    if (opensEast(cellRow, cellCol))
+        mask |= East;
+    if (opensEast(cellRow, cellCol - 1))
+        mask |= West;
+    if (opensSouth(cellRow, cellCol))
+        mask |= South;
+    if (opensSouth(cellRow - 1, cellCol))
+        mask |= North;
+    return mask;
+}
+
+std::vector<std::string> InfiniteMaze::region(int64_t cellRow, int64_t cellCol, int height, int width) const {
+    std::vector<std::string> maze(2 * static_cast<size_t>(height) + 1, std::string(2 * static_cast<size_t>(width) + 1, '#'));
+
+    // Walls between cells of the same level 1 block come from the whole
+    // block worked out at once, the few on block borders are looked up
+    std::map<std::pair<int64_t, int64_t>, std::vector<uint8_t>> blocks;
+    auto maskOf = [&](int64_t r, int64_t c) {
+        std::vector<uint8_t>& block = blocks[{ r >> blockBits, c >> blockBits }];
+        if (block.empty()) {
+            block.resize(blockSide * blockSide);
+            blockPassages(1, r >> blockBits, c >> blockBits, block.data());
+        }
+        return block[(r & (blockSide - 1)) * blockSide + (c & (blockSide - 1))];
+    };
+
+    for (int i = 0; i < height; i++) {
+        int64_t r = cellRow + i;
+        if (r < 0 || r >= side)
+            continue;
+        std::string& cellLine = maze[2 * i + 1];
+        std::string& southLine = maze[2 * i + 2];
+        bool lastRowOfBlock = (r & (blockSide - 1)) == blockSide - 1;
+
+        // west edge of the region: passage from the cell just outside
+        if (opensEast(r, cellCol - 1))
+            cellLine[0] = '.';
+
+        for (int j = 0; j < width; j++) {
+            int64_t c = cellCol + j;
+            if (c < 0 || c >= side)
+                continue;
+            uint8_t mask = maskOf(r, c);
+            bool lastColOfBlock = (c & (blockSide - 1)) == blockSide - 1;
+            cellLine[2 * j + 1] = '.';
+            if (lastColOfBlock ? opensEast(r, c) : (mask & East))
+                cellLine[2 * j + 2] = '.';
+            if (lastRowOfBlock ? opensSouth(r, c) : (mask & South))
+                southLine[2 * j + 1] = '.';
+            // north edge of the region
+            if (i == 0 && opensSouth(r - 1, c))
+                maze[0][2 * j + 1] = '.';
+        }
+    }
+    return maze;
+}
@@ -0,0 +1,69 @@
+#ifndef INFINITE_MAZE_H
+#define INFINITE_MAZE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// A perfect maze with 2^60 x 2^60 cells that is never stored anywhere. Any
+// rectangle of it can be produced on demand from the seed and the
+// rectangle's coordinates alone, and two overlapping or touching regions
+// always agree along their shared walls.
+//
+// The maze is a tree of blocks. A level 1 block is 64 x 64 cells, a level 2
+// block is 64 x 64 level 1 blocks, and so on up to level 10, which is the
+// whole maze. Inside every block its 64 x 64 children are joined by a small
+// Sidewinder maze, turned one of four ways so the straight corridor
+// Sidewinder leaves along one side does not always end up on top:
+//  - whether child (y, x) continues its run east is a hash of the block and y
+//  - the child of a run that opens north is a hash of the block, y and the run
+//  - two children joined that way are blocks themselves, and the wall
+//    between them gets one door, at a hashed spot along their shared side
+// Every block is a maze on its own and they are joined like the cells of a
+// maze, so the whole thing is connected with exactly one path between any
+// two cells, and neighbouring blocks are linked at every depth.
+// Looking up a cell only needs the rows of the few blocks it sits in.
+// Reference -> https://weblog.jamisbuck.org/2011/2/3/maze-generation-sidewinder-algorithm
+class InfiniteMaze {
+public:
+    static const int blockBits = 6;
+    static const int blockSide = 1 << blockBits;
+    static const int levels = 10;
+    // cells along each side of the whole maze
+    static const int64_t side = int64_t(1) << (blockBits * levels);
+
+    explicit InfiniteMaze(uint64_t seed);
+
+    // Cells [cellRow, cellRow + height) x [cellCol, cellCol + width) in the
+    // usual 2x+1 character layout, including the walls around the edge:
+    // (2 * height + 1) rows of (2 * width + 1) characters. Cells outside
+    // [0, side) are walls.
+    std::vector<std::string> region(int64_t cellRow, int64_t cellCol, int height, int width) const;
+
+    // Passage mask (see Passages.h) of a single cell
+    uint8_t passages(int64_t cellRow, int64_t cellCol) const;
+
+    uint64_t getSeed() const;
+
+private:
+    uint64_t seed;
+
+    // Row y of the Sidewinder maze joining the children of a block, before it
+    // is turned: bit x set if child x opens east / north
+    struct SidewinderRow {
+        uint64_t east = 0, north = 0;
+    };
+    SidewinderRow sidewinderRow(int level, int64_t blockRow, int64_t blockCol, int y) const;
+    // Passage mask of child (i, j) in the maze joining the children of a block
+    uint8_t childPassages(int level, int64_t blockRow, int64_t blockCol, int i, int j) const;
+    // Same for every child at once, row by row into out[blockSide * blockSide]
+    void blockPassages(int level, int64_t blockRow, int64_t blockCol, uint8_t* out) const;
+    int turnOf(int level, int64_t blockRow, int64_t blockCol) const;
+    static void untwist(int turn, int i, int j, int& y, int& x);
+    static uint8_t twistedMask(int turn, const SidewinderRow& here, uint64_t below, int x);
+    bool opensEast(int64_t row, int64_t col) const;
+    bool opensSouth(int64_t row, int64_t col) const;
+    uint64_t hash(int64_t row, int64_t col, uint64_t salt) const;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "MappedFile.h"
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filename) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Something went wrong opening " << filename << std::endl;
+        return;
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    length = static_cast<size_t>(fileSize.QuadPart);
+    if (length > 0) {
+        // the view keeps the mapping alive, so both handles can go straight away
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping)
+            bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (mapping)
+            CloseHandle(mapping);
+    }
+    CloseHandle(file);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Something went wrong opening " << filename << std::endl;
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0)
+        length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void* view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            bytes = static_cast<const char*>(view);
+            // rows are read front to back
+            madvise(view, length, MADV_SEQUENTIAL);
+        }
+    }
+    ::close(fd);
+#endif
+    if (length > 0 && !bytes) {
+        std::cerr << "Something went wrong mapping " << filename << std::endl;
+        length = 0;
+        return;
+    }
+    mapped = true;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : bytes(std::exchange(other.bytes, nullptr)), length(std::exchange(other.length, 0)), mapped(std::exchange(other.mapped, false)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+        mapped = std::exchange(other.mapped, false);
+    }
+    return *this;
+}
+
+void MappedFile::close() {
+    if (bytes) {
+#ifdef _WIN32
+        UnmapViewOfFile(bytes);
+#else
+        munmap(const_cast<char*>(bytes), length);
+#endif
+    }
+    bytes = nullptr;
+    length = 0;
+    mapped = false;
+}
+
+bool MappedFile::isOpen() const {
+    return mapped;
+}
+
+const char* MappedFile::data() const {
+    return bytes;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
@@ -0,0 +1,35 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+// A whole file mapped read-only into memory. Pages are only read from disk
+// when they are touched, so opening even a huge file is instant.
+// Uses mmap on POSIX and MapViewOfFile on Windows.
+// Reference -> https://man7.org/linux/man-pages/man2/mmap.2.html
+// Reference -> https://learn.microsoft.com/en-us/windows/win32/memory/creating-a-view-within-a-file-mapping
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool isOpen() const;
+    const char* data() const;
+    size_t size() const;
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+
+    void close();
+};
+
+#endif
@@ -1,96 +1,732 @@
 #include "MazeGenerator.h"
-#include <fstream>
-#include <stack>
-#include <random>
+#include "Passages.h"
+#include "DisjointSet.h"
+#include "BufferedFileWriter.h"
+#include <sstream>
 #include <iostream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <bitset>
 
-MazeGenerator::MazeGenerator(int intRows, int intCols) : rows(intRows), cols(intCols) {
+namespace {
+    // Move for direction d, d is the bit index of the matching Passage
+    const int stepX[4] = { -1, 1, 0, 0 };
+    const int stepY[4] = { 0, 0, -1, 1 };
+
+    // How often loops over single cells look at the cancel flag
+    const size_t checkEvery = 0xFFFF;
+
+    // Backtracking stack that only remembers which way each step went,
+    // 2 bits per step. The current cell is tracked separately, so popping a
+    // step just walks back the opposite way.
+    class DirectionStack {
+    public:
+        void reserve(size_t steps) { bytes.reserve(steps / 4 + 1); }
+        bool empty() const { return count == 0; }
+
+        void push(int d) {
+            if ((count & 3) == 0)
+                bytes.push_back(0);
+            bytes[count >> 2] |= static_cast<uint8_t>(d << ((count & 3) * 2));
+            count++;
+        }
+
+        int pop() {
+            count--;
+            int d = (bytes[count >> 2] >> ((count & 3) * 2)) & 3;
+            if ((count & 3) == 0)
+                bytes.pop_back();
+            else
+                bytes[count >> 2] &= static_cast<uint8_t>(~(3 << ((count & 3) * 2)));
+            return d;
+        }
+
+    private:
+        std::vector<uint8_t> bytes;
+        size_t count = 0;
+    };
+}
+
+MazeGenerator::MazeGenerator(int intRows, int intCols, uint64_t intSeed) : rows(intRows), cols(intCols), seed(intSeed) {
     maze = std::vector<std::vector<char>>(rows, std::vector<char>(cols, '#'));
 }
 
-void MazeGenerator::generate() {
+bool MazeGenerator::generate() {
     if (rows % 2 == 0) 
         rows += 1;
     if (cols % 2 == 0) 
         cols += 1;
 
-    maze = std::vector<std::vector<char>>(rows, std::vector<char>(cols, '#'));
+    cellRows = rows / 2;
+    cellCols = cols / 2;
+    cells.assign(static_cast<size_t>(cellRows) * cellCols, 0);
 
-    carve(1, 1);
+    // Only a single backtracker carve of a perfect maze can record the tree
+    // on the way, everything else rebuilds it afterwards
+    tree = TreeInfo();
+    bool carveRecords = algorithm == Algorithm::Backtracker && tileSize == 0 && braid <= 0.0 && loops <= 0.0;
+    recording = recordTree && carveRecords ? &tree : nullptr;
+    if (recording && !cells.empty()) {
+        tree.parent.assign(cells.size(), TreeInfo::noParent);
+        tree.depth.assign(cells.size(), 0);
+    }
+
+    if (tileSize > 0) {
+        generateTiled();
+    }
+    else {
+        Rng rng(seed);
+        carveRegion({ 0, 0, cellRows, cellCols }, rng);
+    }
+    if (cancelled()) {
+        recording = nullptr;
+        return false;
+    }
+
+    // separate stream so the tree itself does not change with these settings
+    Rng imperfect(Rng::mix(seed, 0x100F5));
+    if (braid > 0.0)
+        removeDeadEnds(imperfect);
+    if (loops > 0.0)
+        removeWalls(imperfect);
+    if (recordTree && !recording)
+        buildTree();
+    recording = nullptr;
+    if (cancelled())
+        return false;
+    expand();
+    if (cancelled())
+        return false;
 
     maze[0][1] = '.';  // Entry point
     maze[rows - 1][cols - 2] = '.';  // Exit
+    return true;
 }
 
-void MazeGenerator::saveToFile(const std::string& filename) {
-    std::ofstream outfile(filename);
-    if (!outfile) {
-        std::cerr << "Something went wrong writing " << filename << std::endl;
+// Turns the passage masks into the character grid: every cell becomes a '.'
+// and so does the wall to its east or south if that passage is open.
+// West and north walls are covered by the neighbour on the other side.
+void MazeGenerator::expand() {
+    maze.assign(rows, std::vector<char>());
+
+    // rows are independent, so split them over threads
+    auto expandRows = [this](int first, int last) {
+        for (int r = first; r < last && !cancelled(); r++) {
+            std::vector<char>& line = maze[r];
+            line.assign(cols, '#');
+            if (r % 2 == 1) {
+                // cell row: the cells themselves plus their east walls
+                const uint8_t* row = &cells[static_cast<size_t>(r / 2) * cellCols];
+                for (int j = 0; j < cellCols; j++) {
+                    line[2 * j + 1] = '.';
+                    if (row[j] & East)
+                        line[2 * j + 2] = '.';
+                }
+            }
+            else if (r > 0 && r < rows - 1) {
+                // wall row: south walls of the cell row above
+                const uint8_t* row = &cells[static_cast<size_t>(r / 2 - 1) * cellCols];
+                for (int j = 0; j < cellCols; j++) {
+                    if (row[j] & South)
+                        line[2 * j + 1] = '.';
+                }
+            }
+        }
+    };
+
+    int workers = threadCount();
+    int band = (rows + workers - 1) / workers;
+    std::vector<std::thread> pool;
+    for (int first = 0; first < rows; first += band)
+        pool.emplace_back(expandRows, first, std::min(rows, first + band));
+    for (auto& t : pool)
+        t.join();
+}
+
+void MazeGenerator::setCancel(const std::atomic<bool>* newCancel) {
+    cancel = newCancel;
+}
+
+// Loops over single cells only look every 64k steps, see checkEvery
+bool MazeGenerator::cancelled() const {
+    return cancel && cancel->load(std::memory_order_relaxed);
+}
+
+int MazeGenerator::threadCount() const {
+    if (threads > 0)
+        return threads;
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+void MazeGenerator::setTileSize(int newTileSize) {
+    tileSize = std::max(0, newTileSize);
+}
+
+int MazeGenerator::getTileSize() const {
+    return tileSize;
+}
+
+void MazeGenerator::setThreads(int newThreads) {
+    threads = newThreads;
+}
+
+int MazeGenerator::getThreads() const {
+    return threads;
+}
+
+void MazeGenerator::setRecordTree(bool record) {
+    recordTree = record;
+}
+
+const MazeGenerator::TreeInfo& MazeGenerator::getTree() const {
+    return tree;
+}
+
+// Parallel generation:
+// Step 1: every tile is carved as its own little perfect maze, with the
+//         selected algorithm, on whichever
+//         thread picks it up, with a random stream derived from (seed, tile)
+//         so the result does not depend on the thread count.
+// Step 2: every pair of neighbouring tiles gets one candidate opening at a
+//         random spot on their shared border.
+// Step 3: Kruskal over those openings in random order joins the tiles into
+//         one tree. The tile graph is tiny compared to the cell count, so this
+//         step is sequential and takes a fraction of a millisecond.
+void MazeGenerator::generateTiled() {
+    int tilesDown = (cellRows + tileSize - 1) / tileSize;
+    int tilesAcross = (cellCols + tileSize - 1) / tileSize;
+    int tileCount = tilesDown * tilesAcross;
+    if (tileCount == 0)
         return;
-    }
 
-    for (auto row : maze) {
-        for (auto cell : row) {
-            outfile << cell;
+    auto tileRegion = [&](int t) {
+        int top = (t / tilesAcross) * tileSize;
+        int left = (t % tilesAcross) * tileSize;
+        return Region{ top, left, std::min(cellRows, top + tileSize), std::min(cellCols, left + tileSize) };
+    };
+
+    std::atomic<int> nextTile(0);
+    auto carveTiles = [&]() {
+        for (int t = nextTile++; t < tileCount && !cancelled(); t = nextTile++) {
+            Region region = tileRegion(t);
+            Rng tileRng(Rng::mix(seed, static_cast<uint64_t>(t)));
+            carveRegion(region, tileRng);
         }
-        outfile << '\n';
+    };
+    std::vector<std::thread> pool;
+    for (int i = 0; i < std::min(threadCount(), tileCount); i++)
+        pool.emplace_back(carveTiles);
+    for (auto& t : pool)
+        t.join();
+    if (cancelled())
+        return;
+
+    // An opening from cell (x, y) of tile a through `passage` into tile b
+    struct BorderWall {
+        int a, b;
+        int x, y;
+        uint8_t passage;
+    };
+    std::vector<BorderWall> walls;
+    Rng rng(seed);
+    for (int t = 0; t < tileCount; t++) {
+        Region region = tileRegion(t);
+        if (t % tilesAcross + 1 < tilesAcross) {
+            int x = region.top + static_cast<int>(rng.bounded(region.bottom - region.top));
+            walls.push_back({ t, t + 1, x, region.right - 1, East });
+        }
+        if (t / tilesAcross + 1 < tilesDown) {
+            int y = region.left + static_cast<int>(rng.bounded(region.right - region.left));
+            walls.push_back({ t, t + tilesAcross, region.bottom - 1, y, South });
+        }
+    }
+
+    // Fisher-Yates shuffle
+    for (size_t i = walls.size(); i > 1; i--)
+        std::swap(walls[i - 1], walls[rng.bounded(static_cast<uint32_t>(i))]);
+
+    DisjointSet tiles(tileCount);
+    for (const auto& wall : walls) {
+        if (!tiles.unite(wall.a, wall.b))
+            continue;
+        size_t here = static_cast<size_t>(wall.x) * cellCols + wall.y;
+        size_t there = wall.passage == East ? here + 1 : here + cellCols;
+        cells[here] |= wall.passage;
+        cells[there] |= opposite(wall.passage);
+    }
+}
+
+const char* MazeGenerator::algorithmName(Algorithm algorithm) {
+    switch (algorithm) {
+    case Algorithm::Kruskal: return "Kruskal";
+    case Algorithm::Prim: return "Prim";
+    case Algorithm::Wilson: return "Wilson";
+    case Algorithm::Sidewinder: return "Sidewinder";
+    case Algorithm::BinaryTree: return "Binary Tree";
+    default: return "Backtracker";
+    }
+}
+
+void MazeGenerator::setAlgorithm(Algorithm newAlgorithm) {
+    algorithm = newAlgorithm;
+}
+
+MazeGenerator::Algorithm MazeGenerator::getAlgorithm() const {
+    return algorithm;
+}
+
+void MazeGenerator::setBraid(double newBraid) {
+    braid = std::min(1.0, std::max(0.0, newBraid));
+}
+
+void MazeGenerator::setLoopDensity(double newLoops) {
+    loops = std::min(1.0, std::max(0.0, newLoops));
+}
+
+double MazeGenerator::getBraid() const {
+    return braid;
+}
+
+double MazeGenerator::getLoopDensity() const {
+    return loops;
+}
+
+void MazeGenerator::setSeed(uint64_t newSeed) {
+    seed = newSeed;
+}
+
+uint64_t MazeGenerator::getSeed() const {
+    return seed;
+}
+
+void MazeGenerator::saveToFile(const std::string& filename) {
+    BufferedFileWriter outfile(filename);
+    if (!outfile.isOpen())
+        return;
+
+    // header line so a saved maze can always be regenerated
+    std::ostringstream header;
+    header << "; seed=" << seed << " generator=" << algorithmName(algorithm);
+    if (tileSize > 0)
+        header << " tile=" << tileSize;
+    if (braid > 0.0)
+        header << " braid=" << braid;
+    if (loops > 0.0)
+        header << " loops=" << loops;
+    header << '\n';
+    std::string headerLine = header.str();
+    outfile.write(headerLine.data(), headerLine.size());
+
+    // whole rows at a time, the writer batches them into big chunks
+    for (const auto& row : maze) {
+        outfile.write(row.data(), row.size());
+        outfile.put('\n');
     }
 
-    outfile.close();
+    if (!outfile.close())
+        std::cerr << "Something went wrong writing " << filename << std::endl;
 }
 
 const std::vector<std::vector<char>>& MazeGenerator::getMaze() const {
     return maze;
 }
 
+const std::vector<uint8_t>& MazeGenerator::getPassages() const {
+    return cells;
+}
+
+int MazeGenerator::getCellRows() const {
+    return cellRows;
+}
+
+int MazeGenerator::getCellCols() const {
+    return cellCols;
+}
+
 // Inspired by the recursive backtracking algorithm but using a stack
 // Inspired by maze escape edugator programming quiz
 // https://weblog.jamisbuck.org/2010/12/27/maze-generation-recursive-backtracking
 // https://stackoverflow.com/questions/16121593/logic-behind-a-stack-based-maze-algorithm
 
-void MazeGenerator::carve(int start_x, int start_y) {
-    std::stack<std::pair<int, int>> stk;
-    stk.push({ start_x, start_y });
-    maze[start_x][start_y] = '.';
+void MazeGenerator::carve(const Region& region, int start_x, int start_y, Rng& rng) {
+    if (region.bottom <= region.top || region.right <= region.left)
+        return;
 
-    std::vector<std::pair<int, int>> directions = {
-        {-2, 0}, {2, 0}, {0, -2}, {0, 2} // 
-    };
+    // A cell is unvisited while its passage mask is still 0. The start cell
+    // gets its first passage on the very first step.
+    // Nothing in the loop below allocates: the stack is reserved for the
+    // deepest possible walk (every cell) up front.
+    DirectionStack stk;
+    stk.reserve(static_cast<size_t>(region.bottom - region.top) * (region.right - region.left));
+
+    int x = start_x;
+    int y = start_y;
 
-    std::random_device rd;
-    std::mt19937 rng(rd());
+    for (size_t step = 1; ; step++) {
+        if ((step & checkEvery) == 0 && cancelled())
+            return;
+        size_t here = static_cast<size_t>(x) * cellCols + y;
 
-    while (!stk.empty()) {
-        int x = stk.top().first;
-        int y = stk.top().second;
+        int candidates[4];
+        int count = 0;
+        if (x > region.top && cells[here - cellCols] == 0)
+            candidates[count++] = 0;
+        if (x + 1 < region.bottom && cells[here + cellCols] == 0)
+            candidates[count++] = 1;
+        if (y > region.left && cells[here - 1] == 0)
+            candidates[count++] = 2;
+        if (y + 1 < region.right && cells[here + 1] == 0)
+            candidates[count++] = 3;
 
-        std::vector<std::vector<int>> neighbors;
+        if (count > 0) {
+            int d = count == 1 ? candidates[0] : candidates[rng.bounded(count)];
+            uint8_t passage = static_cast<uint8_t>(1 << d);
+            x += stepX[d];
+            y += stepY[d];
 
-        for (auto [dx, dy] : directions) {
-            int nx = x + dx;
-            int ny = y + dy;
-            // this makes sure we only carve within the outer borders
-            if ((nx > 0 && nx < rows - 1 && ny > 0 && ny < cols - 1) && maze[nx][ny] == '#') {
-                int wall_x = x + dx / 2;
-                int wall_y = y + dy / 2;
-                neighbors.push_back({ nx, ny, wall_x, wall_y });
+            // knocking down the wall opens it from both sides
+            size_t next = static_cast<size_t>(x) * cellCols + y;
+            cells[here] |= passage;
+            cells[next] |= opposite(passage);
+            stk.push(d);
+
+            if (recording) {
+                recording->parent[next] = static_cast<uint8_t>(d ^ 1);
+                recording->depth[next] = recording->depth[here] + 1;
             }
         }
+        else {
+            // Nothing can carve into a visited cell, so once a cell runs out
+            // of unvisited neighbours its passages are final
+            if (recording) {
+                int degree = static_cast<int>(std::bitset<4>(cells[here]).count());
+                if (degree == 1)
+                    recording->deadEnds.push_back(here);
+                else if (degree >= 3)
+                    recording->junctions.push_back(here);
+            }
+            if (stk.empty())
+                break;
+            int d = stk.pop();
+            x -= stepX[d];
+            y -= stepY[d];
+        }
+    }
+}
 
-        if (!neighbors.empty()) {
-            std::shuffle(neighbors.begin(), neighbors.end(), rng);
-            int nx = neighbors[0][0];
-            int ny = neighbors[0][1];
-            int wall_x = neighbors[0][2];
-            int wall_y = neighbors[0][3];
+// One breadth-first pass from the entrance cell over the finished passages
+void MazeGenerator::buildTree() {
+    size_t count = cells.size();
+    tree.parent.assign(count, TreeInfo::noParent);
+    tree.depth.assign(count, -1);
+    if (count == 0)
+        return;
 
-            maze[wall_x][wall_y] = '.';
-            maze[nx][ny] = '.';
-            stk.push({ nx, ny });
+    std::vector<size_t> queue;
+    queue.reserve(count);
+    queue.push_back(0);
+    tree.depth[0] = 0;
+    for (size_t head = 0; head < queue.size(); head++) {
+        if ((head & checkEvery) == 0 && cancelled())
+            return;
+        size_t here = queue[head];
+        int x = static_cast<int>(here / cellCols);
+        int y = static_cast<int>(here % cellCols);
+        for (int d = 0; d < 4; d++) {
+            if (!(cells[here] & (1 << d)))
+                continue;
+            size_t next = static_cast<size_t>(x + stepX[d]) * cellCols + (y + stepY[d]);
+            if (tree.depth[next] >= 0)
+                continue;
+            tree.parent[next] = static_cast<uint8_t>(d ^ 1);
+            tree.depth[next] = tree.depth[here] + 1;
+            queue.push_back(next);
         }
-        else {
-            stk.pop();
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        int degree = static_cast<int>(std::bitset<4>(cells[i]).count());
+        if (degree == 1)
+            tree.deadEnds.push_back(i);
+        else if (degree >= 3)
+            tree.junctions.push_back(i);
+    }
+}
+
+void MazeGenerator::carveRegion(const Region& region, Rng& rng) {
+    switch (algorithm) {
+    case Algorithm::Kruskal: kruskal(region, rng); break;
+    case Algorithm::Prim: prim(region, rng); break;
+    case Algorithm::Wilson: wilson(region, rng); break;
+    case Algorithm::Sidewinder: sidewinder(region, rng); break;
+    case Algorithm::BinaryTree: binaryTree(region, rng); break;
+    default: carve(region, region.top, region.left, rng); break;
+    }
+}
+
+// Knocks down the wall between cell (x, y) and its neighbour in direction d
+void MazeGenerator::openWall(int x, int y, int d) {
+    uint8_t passage = static_cast<uint8_t>(1 << d);
+    cells[static_cast<size_t>(x) * cellCols + y] |= passage;
+    cells[static_cast<size_t>(x + stepX[d]) * cellCols + (y + stepY[d])] |= opposite(passage);
+}
+
+// Randomized Kruskal: every interior wall in random order, knocked down
+// whenever it separates two cells that are not connected yet.
+// https://weblog.jamisbuck.org/2011/1/3/maze-generation-kruskal-s-algorithm
+void MazeGenerator::kruskal(const Region& region, Rng& rng) {
+    int height = region.bottom - region.top;
+    int width = region.right - region.left;
+    if (height <= 0 || width <= 0)
+        return;
+
+    // wall = local cell index * 2 + (0 for its south wall, 1 for its east wall)
+    std::vector<uint64_t> walls;
+    walls.reserve(static_cast<size_t>(height) * width * 2);
+    for (int i = 0; i < height && !cancelled(); i++) {
+        for (int j = 0; j < width; j++) {
+            uint64_t local = static_cast<uint64_t>(i) * width + j;
+            if (i + 1 < height)
+                walls.push_back(local * 2);
+            if (j + 1 < width)
+                walls.push_back(local * 2 + 1);
+        }
+    }
+    for (size_t i = walls.size(); i > 1; i--) {
+        if ((i & checkEvery) == 0 && cancelled())
+            return;
+        std::swap(walls[i - 1], walls[rng.bounded(static_cast<uint32_t>(i))]);
+    }
+
+    DisjointSet sets(static_cast<size_t>(height) * width);
+    for (size_t w = 0; w < walls.size(); w++) {
+        if ((w & checkEvery) == 0 && cancelled())
+            return;
+        uint64_t wall = walls[w];
+        uint64_t local = wall / 2;
+        bool east = wall & 1;
+        uint64_t other = east ? local + 1 : local + width;
+        if (sets.unite(local, other)) {
+            int x = region.top + static_cast<int>(local / width);
+            int y = region.left + static_cast<int>(local % width);
+            openWall(x, y, east ? 3 : 1);
+        }
+    }
+}
+
+// Randomized Prim: grow the maze from one cell, each step connecting a random
+// frontier cell to a random neighbour already in the maze.
+// https://weblog.jamisbuck.org/2011/1/10/maze-generation-prim-s-algorithm
+void MazeGenerator::prim(const Region& region, Rng& rng) {
+    int height = region.bottom - region.top;
+    int width = region.right - region.left;
+    if (height <= 0 || width <= 0)
+        return;
+
+    const char outside = 0, frontier = 1, inside = 2;
+    std::vector<char> state(static_cast<size_t>(height) * width, outside);
+    std::vector<uint32_t> frontierCells;
+
+    auto addCell = [&](int i, int j) {
+        state[static_cast<size_t>(i) * width + j] = inside;
+        for (int d = 0; d < 4; d++) {
+            int ni = i + stepX[d];
+            int nj = j + stepY[d];
+            if (ni < 0 || nj < 0 || ni >= height || nj >= width)
+                continue;
+            size_t n = static_cast<size_t>(ni) * width + nj;
+            if (state[n] == outside) {
+                state[n] = frontier;
+                frontierCells.push_back(static_cast<uint32_t>(n));
+            }
+        }
+    };
+
+    addCell(static_cast<int>(rng.bounded(height)), static_cast<int>(rng.bounded(width)));
+    for (size_t step = 1; !frontierCells.empty(); step++) {
+        if ((step & checkEvery) == 0 && cancelled())
+            return;
+        // swap-remove a random frontier cell
+        uint32_t pick = rng.bounded(static_cast<uint32_t>(frontierCells.size()));
+        uint32_t local = frontierCells[pick];
+        frontierCells[pick] = frontierCells.back();
+        frontierCells.pop_back();
+
+        int i = static_cast<int>(local / width);
+        int j = static_cast<int>(local % width);
+        int candidates[4];
+        int count = 0;
+        for (int d = 0; d < 4; d++) {
+            int ni = i + stepX[d];
+            int nj = j + stepY[d];
+            if (ni >= 0 && nj >= 0 && ni < height && nj < width && state[static_cast<size_t>(ni) * width + nj] == inside)
+                candidates[count++] = d;
         }
+        openWall(region.top + i, region.left + j, candidates[rng.bounded(count)]);
+        addCell(i, j);
     }
 }
 
+// Wilson's algorithm: loop-erased random walks from every cell not yet in
+// the tree until they hit it. Produces every spanning tree with equal
+// probability, at the cost of long walks at the start.
+// https://weblog.jamisbuck.org/2011/1/20/maze-generation-wilson-s-algorithm
+void MazeGenerator::wilson(const Region& region, Rng& rng) {
+    int height = region.bottom - region.top;
+    int width = region.right - region.left;
+    if (height <= 0 || width <= 0)
+        return;
+
+    std::vector<char> inTree(static_cast<size_t>(height) * width, 0);
+    // last direction the current walk left each cell in; overwriting it when
+    // the walk comes back is what erases the loop
+    std::vector<uint8_t> walkDir(static_cast<size_t>(height) * width, 0);
+
+    inTree[rng.bounded(static_cast<uint32_t>(inTree.size()))] = 1;
+    size_t steps = 0;
+    for (size_t start = 0; start < inTree.size(); start++) {
+        if (inTree[start])
+            continue;
+
+        int i = static_cast<int>(start / width);
+        int j = static_cast<int>(start % width);
+        while (!inTree[static_cast<size_t>(i) * width + j]) {
+            if ((++steps & checkEvery) == 0 && cancelled())
+                return;
+            int candidates[4];
+            int count = 0;
+            if (i > 0) candidates[count++] = 0;
+            if (i + 1 < height) candidates[count++] = 1;
+            if (j > 0) candidates[count++] = 2;
+            if (j + 1 < width) candidates[count++] = 3;
+            if (count == 0)
+                break;
+            int d = candidates[rng.bounded(count)];
+            walkDir[static_cast<size_t>(i) * width + j] = static_cast<uint8_t>(d);
+            i += stepX[d];
+            j += stepY[d];
+        }
+
+        // retrace the loop-free path and add it to the tree
+        i = static_cast<int>(start / width);
+        j = static_cast<int>(start % width);
+        while (!inTree[static_cast<size_t>(i) * width + j]) {
+            size_t local = static_cast<size_t>(i) * width + j;
+            int d = walkDir[local];
+            inTree[local] = 1;
+            openWall(region.top + i, region.left + j, d);
+            i += stepX[d];
+            j += stepY[d];
+        }
+    }
+}
+
+// Sidewinder: row by row, keep extending a run east and at random close it by
+// carving north from one random cell of the run. The top row is one corridor.
+// https://weblog.jamisbuck.org/2011/2/3/maze-generation-sidewinder-algorithm
+void MazeGenerator::sidewinder(const Region& region, Rng& rng) {
+    for (int x = region.top; x < region.bottom && !cancelled(); x++) {
+        int runStart = region.left;
+        for (int y = region.left; y < region.right; y++) {
+            bool lastInRow = y + 1 == region.right;
+            bool topRow = x == region.top;
+            if (topRow || (!lastInRow && (rng.next() >> 63))) {
+                if (!lastInRow)
+                    openWall(x, y, 3);
+            }
+            else {
+                int north = runStart + static_cast<int>(rng.bounded(y - runStart + 1));
+                openWall(x, north, 0);
+                runStart = y + 1;
+            }
+        }
+    }
+}
+
+// Binary Tree: every cell carves either north or east. The top row can only
+// go east and the last column only north.
+// https://weblog.jamisbuck.org/2011/2/1/maze-generation-binary-tree-algorithm
+void MazeGenerator::binaryTree(const Region& region, Rng& rng) {
+    uint64_t bits = 0;
+    int bitsLeft = 0;
+    for (int x = region.top; x < region.bottom && !cancelled(); x++) {
+        for (int y = region.left; y < region.right; y++) {
+            bool canNorth = x > region.top;
+            bool canEast = y + 1 < region.right;
+            if (canNorth && canEast) {
+                if (bitsLeft == 0) {
+                    bits = rng.next();
+                    bitsLeft = 64;
+                }
+                openWall(x, y, (bits & 1) ? 0 : 3);
+                bits >>= 1;
+                bitsLeft--;
+            }
+            else if (canNorth) {
+                openWall(x, y, 0);
+            }
+            else if (canEast) {
+                openWall(x, y, 3);
+            }
+        }
+    }
+}
+
+// Braiding: visit the dead ends in random order and knock each one through
+// into a neighbour with probability braid. Another dead end is preferred as
+// the neighbour since that removes two dead ends with one wall.
+// https://weblog.jamisbuck.org/2015/10/31/mazes-blockwise-and-braids.html
+void MazeGenerator::removeDeadEnds(Rng& rng) {
+    auto degree = [](uint8_t mask) {
+        return (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+    };
+
+    std::vector<size_t> deadEnds;
+    for (size_t i = 0; i < cells.size(); i++) {
+        if (degree(cells[i]) == 1)
+            deadEnds.push_back(i);
+    }
+    for (size_t i = deadEnds.size(); i > 1; i--)
+        std::swap(deadEnds[i - 1], deadEnds[rng.bounded(static_cast<uint32_t>(i))]);
+
+    for (size_t k = 0; k < deadEnds.size(); k++) {
+        if ((k & checkEvery) == 0 && cancelled())
+            return;
+        size_t i = deadEnds[k];
+        // an earlier step may already have joined this one
+        if (degree(cells[i]) != 1 || !(rng.uniform() < braid))
+            continue;
+
+        int x = static_cast<int>(i / cellCols);
+        int y = static_cast<int>(i % cellCols);
+        int candidates[4], preferred[4];
+        int count = 0, preferredCount = 0;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + stepX[d];
+            int ny = y + stepY[d];
+            if (nx < 0 || ny < 0 || nx >= cellRows || ny >= cellCols || (cells[i] & (1 << d)))
+                continue;
+            candidates[count++] = d;
+            if (degree(cells[static_cast<size_t>(nx) * cellCols + ny]) == 1)
+                preferred[preferredCount++] = d;
+        }
+        if (preferredCount > 0)
+            openWall(x, y, preferred[rng.bounded(preferredCount)]);
+        else if (count > 0)
+            openWall(x, y, candidates[rng.bounded(count)]);
+    }
+}
+
+// Knocks down each remaining interior wall with probability loops
+void MazeGenerator::removeWalls(Rng& rng) {
+    for (int x = 0; x < cellRows && !cancelled(); x++) {
+        for (int y = 0; y < cellCols; y++) {
+            uint8_t mask = cells[static_cast<size_t>(x) * cellCols + y];
+            if (x + 1 < cellRows && !(mask & South) && rng.uniform() < loops)
+                openWall(x, y, 1);
+            if (y + 1 < cellCols && !(mask & East) && rng.uniform() < loops)
+                openWall(x, y, 3);
+        }
+    }
+}
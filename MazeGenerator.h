@@ -3,19 +3,116 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <atomic>
+#include "Rng.h"
 
+// The maze is carved on a lattice of cells, (rows / 2) x (cols / 2), where
+// every cell only stores a 4-bit passage mask (see Passages.h). getMaze()
+// expands that into the usual 2x+1 character grid with wall cells in between,
+// cell (i, j) landing on character (2i + 1, 2j + 1).
 class MazeGenerator {
 public:
-    MazeGenerator(int rows, int cols);
-    void generate();
+    // Perfect-maze algorithms. They all produce spanning trees but with very
+    // different shapes: Backtracker gives long winding corridors, Kruskal and
+    // Prim lots of short dead ends, Wilson a uniformly random tree, and
+    // Sidewinder / Binary Tree a straight top corridor and a diagonal bias.
+    // Reference -> https://weblog.jamisbuck.org/2011/2/7/maze-generation-algorithm-recap
+    enum class Algorithm { Backtracker, Kruskal, Prim, Wilson, Sidewinder, BinaryTree };
+    static const char* algorithmName(Algorithm algorithm);
+
+    // The same seed always produces the same maze
+    MazeGenerator(int rows, int cols, uint64_t seed = Rng::randomSeed());
+    // false if it was cancelled (see setCancel), the maze is then half built
+    bool generate();
+    void setSeed(uint64_t seed);
+    uint64_t getSeed() const;
+    void setAlgorithm(Algorithm algorithm);
+    Algorithm getAlgorithm() const;
     void saveToFile(const std::string& filename);
     const std::vector<std::vector<char>>& getMaze() const;
 
+    // Turn the perfect maze into an imperfect one afterwards.
+    // braid: fraction of dead ends (0..1) that get knocked through into a
+    //        neighbour, which creates loops without opening up rooms.
+    // loops: fraction of the remaining interior walls (0..1) removed at
+    //        random, which adds more loops and eventually open areas.
+    void setBraid(double braid);
+    void setLoopDensity(double loops);
+    double getBraid() const;
+    double getLoopDensity() const;
+
+    // tileSize > 0 carves independent tileSize x tileSize cell tiles on
+    // several threads and then joins them into one spanning tree.
+    // 0 (the default) carves the whole maze in one go.
+    void setTileSize(int tileSize);
+    int getTileSize() const;
+    // threads <= 0 means use std::thread::hardware_concurrency()
+    void setThreads(int threads);
+    int getThreads() const;
+
+    // Not owned. generate() gives up soon after *cancel becomes true, which
+    // can be set from any thread. nullptr (the default) never cancels.
+    void setCancel(const std::atomic<bool>* cancel);
+
+    // Spanning-tree view of the maze, rooted at the entrance cell (0, 0).
+    // Cell index = i * cellCols + j, as in getPassages().
+    struct TreeInfo {
+        static constexpr uint8_t noParent = 4;
+        std::vector<uint8_t> parent;   // Passage bit index leading towards the root, noParent at the root
+        std::vector<int> depth;        // passages between the cell and the root
+        // uint64_t rather than size_t so these go into a MazeIndexFile as is
+        std::vector<uint64_t> junctions; // cells with three or four passages
+        std::vector<uint64_t> deadEnds;  // cells with a single passage
+    };
+
+    // Fill in getTree() on every generate(). The backtracker records it while
+    // carving. Every other algorithm, tiled generation, and braided or looped
+    // mazes get it from one breadth-first pass over the finished passages, so
+    // depth is always the distance to the root.
+    void setRecordTree(bool record);
+    const TreeInfo& getTree() const;
+
+    const std::vector<uint8_t>& getPassages() const;
+    int getCellRows() const;
+    int getCellCols() const;
+
 private:
     int rows, cols;
+    int cellRows = 0, cellCols = 0;
+    uint64_t seed;
+    Algorithm algorithm = Algorithm::Backtracker;
+    int tileSize = 0;
+    double braid = 0.0;
+    double loops = 0.0;
+    int threads = 0;
+    bool recordTree = false;
+    const std::atomic<bool>* cancel = nullptr;
+    TreeInfo* recording = nullptr;
+    TreeInfo tree;
+    std::vector<uint8_t> cells;
     std::vector<std::vector<char>> maze;
-    bool is_valid(int x, int y);
-    void carve(int start_x, int start_y);
+
+    // Cells [top, bottom) x [left, right) that a carve has to stay inside
+    struct Region {
+        int top, left, bottom, right;
+    };
+
+    int threadCount() const;
+    bool cancelled() const;
+    void carveRegion(const Region& region, Rng& rng);
+    void carve(const Region& region, int start_x, int start_y, Rng& rng);
+    void kruskal(const Region& region, Rng& rng);
+    void prim(const Region& region, Rng& rng);
+    void wilson(const Region& region, Rng& rng);
+    void sidewinder(const Region& region, Rng& rng);
+    void binaryTree(const Region& region, Rng& rng);
+    void openWall(int x, int y, int d);
+    void removeDeadEnds(Rng& rng);
+    void removeWalls(Rng& rng);
+    void generateTiled();
+    void buildTree();
+    void expand();
 };
 
-#endif
\ No newline at end of file
+#endif
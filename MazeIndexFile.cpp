@@ -0,0 +1,177 @@
+#include "MazeIndexFile.h"
+#include "BinaryMazeFile.h"
+#include "BufferedFileWriter.h"
+#include <cstring>
+#include <climits>
+#include <iostream>
+
+namespace {
+    const char magicBytes[4] = { 'M', 'A', 'Z', 'I' };
+    const uint64_t sectionAlignment = 64;
+
+    uint64_t alignUp(uint64_t offset) {
+        return (offset + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+    }
+}
+
+MazeIndexWriter::MazeIndexWriter(int rows, int cols, uint64_t seed, uint64_t fingerprint) {
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, magicBytes, sizeof(magicBytes));
+    header.version = MazeIndexFile::version;
+    header.rows = static_cast<uint32_t>(rows);
+    header.cols = static_cast<uint32_t>(cols);
+    header.seed = seed;
+    header.fingerprint = fingerprint;
+}
+
+void MazeIndexWriter::add(IndexSection kind, const void* data, size_t count, uint32_t elementSize, uint64_t param) {
+    MazeIndexSection entry = {};
+    entry.kind = static_cast<uint32_t>(kind);
+    entry.elementSize = elementSize;
+    entry.count = count;
+    entry.param = param;
+    sections.push_back({ entry, data });
+}
+
+void MazeIndexWriter::addComponents(const ComponentLabeler& components) {
+    if (components.empty())
+        return;
+    size_t count = static_cast<size_t>(components.getRows()) * components.getCols();
+    add(IndexSection::ComponentLabels, components.getLabels(), count, sizeof(int), components.componentCount());
+}
+
+void MazeIndexWriter::addTree(const MazeGenerator::TreeInfo& tree) {
+    if (tree.parent.empty())
+        return;
+    add(IndexSection::TreeParents, tree.parent);
+    add(IndexSection::TreeDepths, tree.depth);
+    add(IndexSection::Junctions, tree.junctions);
+    add(IndexSection::DeadEnds, tree.deadEnds);
+}
+
+bool MazeIndexWriter::save(const std::string& filename) {
+    // lay the sections out and checksum them before anything is written
+    header.sectionCount = static_cast<uint32_t>(sections.size());
+    header.tableOffset = sizeof(MazeIndexHeader);
+    uint64_t offset = alignUp(header.tableOffset + sections.size() * sizeof(MazeIndexSection));
+    std::vector<MazeIndexSection> table;
+    for (Pending& section : sections) {
+        uint64_t size = section.entry.count * section.entry.elementSize;
+        section.entry.offset = offset;
+        section.entry.checksum = BinaryMazeFile::fnv1a(static_cast<const uint8_t*>(section.data), size);
+        table.push_back(section.entry);
+        offset = alignUp(offset + size);
+    }
+
+    BufferedFileWriter outfile(filename);
+    if (!outfile.isOpen())
+        return false;
+    outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outfile.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(MazeIndexSection));
+    uint64_t written = sizeof(header) + table.size() * sizeof(MazeIndexSection);
+    for (const Pending& section : sections) {
+        for (; written < section.entry.offset; written++)
+            outfile.put(0);
+        uint64_t size = section.entry.count * section.entry.elementSize;
+        outfile.write(static_cast<const char*>(section.data), size);
+        written += size;
+    }
+    if (!outfile.close()) {
+        std::cerr << "Something went wrong writing " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string MazeIndexFile::sidecarFor(const std::string& mazeFilename) {
+    return mazeFilename + ".idx";
+}
+
+uint64_t MazeIndexFile::fingerprint(const std::vector<std::string>& maze) {
+    uint64_t hash = BinaryMazeFile::fnv1a(nullptr, 0);
+    for (const auto& row : maze)
+        hash = BinaryMazeFile::fnv1a(reinterpret_cast<const uint8_t*>(row.data()), row.size(), hash);
+    return hash;
+}
+
+uint64_t MazeIndexFile::fingerprint(const GridView& maze) {
+    uint64_t hash = BinaryMazeFile::fnv1a(nullptr, 0);
+    for (int r = 0; r < maze.getRows(); r++)
+        hash = BinaryMazeFile::fnv1a(reinterpret_cast<const uint8_t*>(maze[r]), maze.getCols(), hash);
+    return hash;
+}
+
+bool MazeIndexFile::load(const std::string& filename) {
+    header = nullptr;
+    table = nullptr;
+    file = MappedFile(filename);
+    if (!file.isOpen())
+        return false;
+
+    auto fail = [&](const char* why) {
+        std::cerr << filename << ": " << why << std::endl;
+        file = MappedFile();
+        return false;
+    };
+    if (file.size() < sizeof(MazeIndexHeader) || std::memcmp(file.data(), magicBytes, sizeof(magicBytes)) != 0)
+        return fail("not a maze index file");
+
+    const MazeIndexHeader* h = reinterpret_cast<const MazeIndexHeader*>(file.data());
+    if (h->version > version)
+        return fail("written by a newer version");
+    if (h->tableOffset % 8 != 0 || h->tableOffset > file.size() ||
+        static_cast<uint64_t>(h->sectionCount) * sizeof(MazeIndexSection) > file.size() - h->tableOffset)
+        return fail("file is truncated");
+
+    // the table is tiny, so every entry is checked now and get() never has to
+    const MazeIndexSection* entries = reinterpret_cast<const MazeIndexSection*>(file.data() + h->tableOffset);
+    for (uint32_t i = 0; i < h->sectionCount; i++) {
+        const MazeIndexSection& s = entries[i];
+        if (s.offset % sectionAlignment != 0 || s.elementSize == 0 || s.offset > file.size() ||
+            s.count > (file.size() - s.offset) / s.elementSize)
+            return fail("section table points outside the file");
+    }
+    header = h;
+    table = entries;
+    return true;
+}
+
+bool MazeIndexFile::verify() const {
+    if (!header)
+        return false;
+    for (uint32_t i = 0; i < header->sectionCount; i++) {
+        const MazeIndexSection& s = table[i];
+        if (BinaryMazeFile::fnv1a(reinterpret_cast<const uint8_t*>(file.data() + s.offset), s.count * s.elementSize) != s.checksum)
+            return false;
+    }
+    return true;
+}
+
+const MazeIndexHeader& MazeIndexFile::getHeader() const {
+    return *header;
+}
+
+bool MazeIndexFile::matches(int rows, int cols, uint64_t fingerprint) const {
+    return header && header->rows == static_cast<uint32_t>(rows) && header->cols == static_cast<uint32_t>(cols) &&
+           header->fingerprint == fingerprint;
+}
+
+const MazeIndexSection* MazeIndexFile::find(IndexSection kind) const {
+    if (!header)
+        return nullptr;
+    for (uint32_t i = 0; i < header->sectionCount; i++) {
+        if (table[i].kind == static_cast<uint32_t>(kind))
+            return &table[i];
+    }
+    return nullptr;
+}
+
+ComponentLabeler MazeIndexFile::components() const {
+    size_t count;
+    const int* labels = get<int>(IndexSection::ComponentLabels, count);
+    if (!labels || count != static_cast<uint64_t>(header->rows) * header->cols || header->rows > INT_MAX || header->cols > INT_MAX ||
+        count > ComponentLabeler::maxCells)
+        return ComponentLabeler();
+    return ComponentLabeler(labels, static_cast<int>(header->rows), static_cast<int>(header->cols),
+                            static_cast<int>(find(IndexSection::ComponentLabels)->param));
+}
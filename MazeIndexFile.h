@@ -0,0 +1,134 @@
+#ifndef MAZE_INDEX_FILE_H
+#define MAZE_INDEX_FILE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "MappedFile.h"
+#include "GridView.h"
+#include "ComponentLabeler.h"
+#include "MazeGenerator.h"
+
+// Sidecar file (maze.txt -> maze.txt.idx) holding anything worked out from
+// a maze that is slow to rebuild, so a big maze starts up by mapping the
+// file instead of preprocessing it again.
+//
+//   MazeIndexHeader       64 bytes at offset 0
+//   section table         sectionCount x MazeIndexSection at tableOffset
+//   sections              each one a plain array, starting on a 64 byte
+//                         boundary so it can be used in place
+//
+// The header records the size, seed and a fingerprint of the maze it was
+// built for, so matches() can tell a stale sidecar from a good one. Every
+// section has its own FNV-1a checksum (see BinaryMazeFile.h), checked only
+// by verify(). Numbers are little-endian, like the maze files.
+enum class IndexSection : uint32_t {
+    ComponentLabels = 1, // int32 per character, see ComponentLabeler; param = component count.
+                         // Only written for mazes of up to ComponentLabeler::maxCells characters.
+    TreeParents = 2,     // uint8 per cell, see MazeGenerator::TreeInfo
+    TreeDepths = 3,      // int32 per cell
+    Junctions = 4,       // uint64 cell indices
+    DeadEnds = 5,        // uint64 cell indices
+    // ids from here up are free for anything else a caller wants to keep
+    FirstCustom = 0x10000
+};
+
+struct MazeIndexHeader {
+    char magic[4];          // "MAZI"
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t rows, cols;    // character grid of the maze
+    uint32_t sectionCount;
+    uint32_t reserved2;
+    uint64_t seed;
+    uint64_t fingerprint;   // MazeIndexFile::fingerprint of the maze
+    uint64_t tableOffset;
+    uint64_t reserved3[2];
+};
+
+struct MazeIndexSection {
+    uint32_t kind;          // IndexSection
+    uint32_t elementSize;
+    uint64_t offset;        // from the start of the file
+    uint64_t count;         // elements
+    uint64_t param;         // section specific, 0 if unused
+    uint64_t checksum;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(MazeIndexHeader) == 64, "header layout is part of the file format");
+static_assert(sizeof(MazeIndexSection) == 48, "section layout is part of the file format");
+
+// Collects sections and writes them out. Nothing is copied: the arrays
+// handed to add() have to stay alive until save().
+class MazeIndexWriter {
+public:
+    MazeIndexWriter(int rows, int cols, uint64_t seed, uint64_t fingerprint);
+
+    void add(IndexSection kind, const void* data, size_t count, uint32_t elementSize, uint64_t param = 0);
+    template <typename T>
+    void add(IndexSection kind, const std::vector<T>& values, uint64_t param = 0) {
+        add(kind, values.data(), values.size(), sizeof(T), param);
+    }
+    // a temporary would be gone by save()
+    template <typename T>
+    void add(IndexSection kind, const std::vector<T>&& values, uint64_t param = 0) = delete;
+    void addComponents(const ComponentLabeler& components);
+    void addTree(const MazeGenerator::TreeInfo& tree);
+
+    // Prints what went wrong and returns false if the file could not be written
+    bool save(const std::string& filename);
+
+private:
+    struct Pending {
+        MazeIndexSection entry;
+        const void* data;
+    };
+
+    MazeIndexHeader header;
+    std::vector<Pending> sections;
+};
+
+class MazeIndexFile {
+public:
+    static constexpr uint16_t version = 1;
+
+    // Where the index of a maze file lives
+    static std::string sidecarFor(const std::string& mazeFilename);
+    // FNV-1a over the characters of the maze, line endings left out
+    static uint64_t fingerprint(const std::vector<std::string>& maze);
+    static uint64_t fingerprint(const GridView& maze);
+
+    // Maps the file and checks the header and the section table. Prints
+    // what went wrong and returns false if this version can't read it.
+    bool load(const std::string& filename);
+    // Reads every section and compares the checksums
+    bool verify() const;
+
+    const MazeIndexHeader& getHeader() const;
+    // Same size and fingerprint as the maze the index was built for
+    bool matches(int rows, int cols, uint64_t fingerprint) const;
+
+    // nullptr if there is no such section
+    const MazeIndexSection* find(IndexSection kind) const;
+    // The section as an array of T in the mapping, nullptr if it is missing
+    // or its elements are not sizeof(T) bytes
+    template <typename T>
+    const T* get(IndexSection kind, size_t& count) const {
+        const MazeIndexSection* section = find(kind);
+        count = section && section->elementSize == sizeof(T) ? static_cast<size_t>(section->count) : 0;
+        return count > 0 ? reinterpret_cast<const T*>(file.data() + section->offset) : nullptr;
+    }
+
+    // Component labels straight out of the mapping, empty if there are none.
+    // The labeler is only valid while this file stays loaded.
+    ComponentLabeler components() const;
+
+private:
+    MappedFile file;
+    const MazeIndexHeader* header = nullptr;
+    const MazeIndexSection* table = nullptr;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "MazeLoader.h"
+#include <cstring>
+#include <climits>
+#include <iostream>
+
+bool MazeLoader::load(const std::string& filename) {
+    if (open(filename) && checkRows(0, view.getRows()))
+        return true;
+    view = GridView();
+    return false;
+}
+
+bool MazeLoader::open(const std::string& filename) {
+    view = GridView();
+    header.clear();
+    file = MappedFile(filename);
+    if (!file.isOpen())
+        return false;
+
+    const char* p = file.data();
+    const char* end = p + file.size();
+
+    // header lines
+    while (p < end && *p == ';') {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = newline ? newline : end;
+        if (header.empty()) {
+            const char* text = p + 1;
+            if (text < lineEnd && *text == ' ')
+                text++;
+            header.assign(text, lineEnd);
+            if (!header.empty() && header.back() == '\r')
+                header.pop_back();
+        }
+        p = newline ? newline + 1 : end;
+    }
+    if (p == end) {
+        std::cerr << filename << " has no maze in it" << std::endl;
+        return false;
+    }
+
+    // The first line decides the width and the line ending for all of them
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    size_t lineLength = newline ? newline - p : end - p;
+    crlf = lineLength > 0 && p[lineLength - 1] == '\r';
+    size_t cols = crlf ? lineLength - 1 : lineLength;
+    size_t eol = crlf ? 2 : 1;
+    size_t stride = cols + eol;
+    size_t body = end - p;
+
+    // every line is exactly stride bytes, except maybe a last one without its line ending
+    size_t rows = (body + eol) / stride;
+    if (cols == 0 || (body % stride != 0 && (body + eol) % stride != 0) || rows > INT_MAX || cols > INT_MAX) {
+        std::cerr << filename << " is not a rectangular maze" << std::endl;
+        return false;
+    }
+    lastHasEnding = body % stride == 0;
+    name = filename;
+    view = GridView(p, static_cast<int>(rows), static_cast<int>(cols), stride);
+    return true;
+}
+
+// One pass over the rows: memchr is vectorised in every C library, so
+// checking that no row hides a line break runs at memory speed
+bool MazeLoader::checkRows(int first, int last) const {
+    size_t cols = view.getCols();
+    size_t eol = crlf ? 2 : 1;
+    for (int r = first; r < last; r++) {
+        const char* row = view[r];
+        bool ending = r + 1 < view.getRows() || lastHasEnding;
+        if (std::memchr(row, '\n', cols) ||
+            (ending && (row[cols + eol - 1] != '\n' || (crlf && row[cols] != '\r')))) {
+            std::cerr << name << ": line " << r + 1 << " does not have " << cols << " characters" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+const GridView& MazeLoader::getView() const {
+    return view;
+}
+
+const std::string& MazeLoader::getHeader() const {
+    return header;
+}
+
+std::string MazeLoader::headerField(const std::string& key) const {
+    std::string prefix = key + "=";
+    size_t at = 0;
+    while ((at = header.find(prefix, at)) != std::string::npos) {
+        if (at == 0 || header[at - 1] == ' ') {
+            size_t begin = at + prefix.size();
+            size_t stop = header.find(' ', begin);
+            return header.substr(begin, stop == std::string::npos ? std::string::npos : stop - begin);
+        }
+        at += prefix.size();
+    }
+    return "";
+}
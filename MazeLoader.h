@@ -0,0 +1,43 @@
+#ifndef MAZE_LOADER_H
+#define MAZE_LOADER_H
+
+#include <string>
+#include "MappedFile.h"
+#include "GridView.h"
+
+// Loads a text maze (rows of '#' and '.', like saveToFile writes) without
+// reading it into strings. The file is memory-mapped and getView() points
+// straight into the mapping, so the loader has to outlive the view.
+//
+// Lines starting with ';' at the top of the file are header lines and are
+// skipped. Lines can end in "\n" or "\r\n", and the last line may or may not
+// have one, but every line has to have the same length.
+class MazeLoader {
+public:
+    // Prints what went wrong and returns false if the file is missing or
+    // not a rectangular maze
+    bool load(const std::string& filename);
+
+    // load() in two steps, for reading a big file a bit at a time: open()
+    // maps the file and works out the size from the first line only, and
+    // checkRows() then checks rows [first, last). Rows of getView() are only
+    // safe to use once they have been checked.
+    bool open(const std::string& filename);
+    bool checkRows(int first, int last) const;
+
+    const GridView& getView() const;
+    // The first header line without its "; ", empty if there is none
+    const std::string& getHeader() const;
+    // Value of a "key=value" field of the header, empty if it is missing
+    std::string headerField(const std::string& key) const;
+
+private:
+    MappedFile file;
+    GridView view;
+    std::string header;
+    std::string name;
+    bool crlf = false;
+    bool lastHasEnding = false;
+};
+
+#endif
@@ -7,9 +7,16 @@
 // heavily referencing sfml documentation to make many of these work
 // https://www.sfml-dev.org/documentation/2.6.2/
 
+MazeRenderer::~MazeRenderer() {
+    stopBuilding = true;
+    if (worker.valid())
+        worker.wait();
+}
+
 void MazeRenderer::run() {
     while (window.isOpen()) {
         processEvents();
+        updateMaze();
         render();
     }
 }
@@ -20,6 +27,27 @@ void MazeRenderer::processEvents() {
         if (event.type == sf::Event::Closed)
             window.close();
 
+        // half a window at a time, so there is always something to go by
+        if (infinite && event.type == sf::Event::KeyPressed) {
+            int64_t height = (rows - 1) / 2, width = (cols - 1) / 2;
+            int64_t row = regionRow, col = regionCol;
+            if (event.key.code == sf::Keyboard::Up)
+                row -= height / 2;
+            else if (event.key.code == sf::Keyboard::Down)
+                row += height / 2;
+            else if (event.key.code == sf::Keyboard::Left)
+                col -= width / 2;
+            else if (event.key.code == sf::Keyboard::Right)
+                col += width / 2;
+            row = std::max<int64_t>(0, std::min(row, InfiniteMaze::side - height));
+            col = std::max<int64_t>(0, std::min(col, InfiniteMaze::side - width));
+            if (row != regionRow || col != regionCol) {
+                regionRow = row;
+                regionCol = col;
+                showRegion();
+            }
+        }
+
         if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
             sf::Vector2f mousePos = window.mapPixelToCoords({ event.mouseButton.x, event.mouseButton.y }, window.getDefaultView());
 
@@ -28,24 +56,50 @@ void MazeRenderer::processEvents() {
                 selectedAlgoText.setString(algorithms[selectedIndex]);
             }
 
-            if (startButton.getGlobalBounds().contains(mousePos)) {
-                Algorithms solver(maze);
+            // nothing to solve until the whole file is in
+            if (!loading && startButton.getGlobalBounds().contains(mousePos)) {
                 Algorithms::Point start = { 0, 1 };
                 Algorithms::Point goal = { static_cast<int>(maze.size()) - 1, static_cast<int>(maze[0].size()) - 2 };
+                // a region of the infinite maze has no entrance or exit, so
+                // go from corner to corner (the path may leave the region)
+                if (infinite) {
+                    start = { 1, 1 };
+                    goal = { rows - 2, cols - 2 };
+                }
+
+                // pruning is preprocessing, so it is done once per maze and not timed
+                if (pruneDeadEnds && prunedMaze.empty()) {
+                    DeadEndFiller filler(maze, start, goal);
+                    filler.fill();
+                    prunedMaze = filler.getMaze();
+                }
+                Algorithms solver = !pruneDeadEnds && !passages.empty() ?
+                    Algorithms(passages, (rows - 1) / 2, (cols - 1) / 2) : Algorithms(pruneDeadEnds ? prunedMaze : maze);
+                solver.setComponents(&components);
 
                 // https://en.cppreference.com/w/cpp/chrono/steady_clock/now
                 // how to use steady_clock
                 startTime = std::chrono::steady_clock::now();
 
+                // every query gets the same hard budget so the window never hangs
+                SearchBudget budget = SearchBudget::within(queryBudget);
+
                 if (algorithms[selectedIndex] == "Dijkstra")
-                    solver.runDijkstra(start, goal);
+                    solver.runDijkstra(start, goal, budget);
                 else if (algorithms[selectedIndex] == "BFS")
-                    solver.runBFS(start, goal);
+                    solver.runBFS(start, goal, budget);
                 else if (algorithms[selectedIndex] == "DFS")
-                    solver.runDFS(start, goal);
+                    solver.runDFS(start, goal, budget);
+                else if (algorithms[selectedIndex] == "A*")
+                    solver.runAnytimeAStar(start, goal, budget);
 
 
                 elapsedTime = std::chrono::steady_clock::now() - startTime;
+                // DFS, or an anytime search that ran out of time, can end on a longer path
+                if (solver.getPath().empty() || solver.getPath().back() != goal)
+                    resultNote = solver.wasInterrupted() ? " (partial)" : " (no path)";
+                else
+                    resultNote = solver.isOptimal() ? "" : " (not optimal)";
 
                 visitedPoints = solver.getVisited();
                 pathPoints = solver.getPath();
@@ -58,9 +112,24 @@ void MazeRenderer::processEvents() {
             if (skipButton.getGlobalBounds().contains(mousePos)) {
                 skipAnimation = true;
             }
+            if (pruneButton.getGlobalBounds().contains(mousePos)) {
+                pruneDeadEnds = !pruneDeadEnds;
+                pruneButtonText.setString(pruneDeadEnds ? "Fill Dead Ends: On" : "Fill Dead Ends: Off");
+            }
+            if (generatorBox.getGlobalBounds().contains(mousePos)) {
+                // same seed, different algorithm, so the shapes can be compared
+                generatorIndex = (generatorIndex + 1) % generators.size();
+                wanted.algorithm = generators[generatorIndex];
+                generatorText.setString(std::string("Maze: ") + MazeGenerator::algorithmName(generators[generatorIndex]));
+            }
+            if (braidBox.getGlobalBounds().contains(mousePos)) {
+                braidIndex = (braidIndex + 1) % braidLevels.size();
+                wanted.braid = braidLevels[braidIndex] / 100.0;
+                braidText.setString("Loops (braid): " + std::to_string(braidLevels[braidIndex]) + "%");
+            }
             if (resetButton.getGlobalBounds().contains(mousePos)) {
-                updateMaze();
-
+                // step the seed so every reset is new but still reproducible
+                wanted.seed++;
             }
         }
     }
@@ -96,11 +165,14 @@ void MazeRenderer::render() {
     // Drawing the maze with white and black tiles
     sf::RectangleShape tile(sf::Vector2f(tileSize, tileSize));
 
-    for (int y = 0; y < rows; y++) {
+    // While a file is loading only the rows read so far are drawn
+    const std::vector<std::string>& drawn = loading ? loader->getMaze() : maze;
+    int drawnRows = loading ? loader->rowsReady() : rows;
+    for (int y = 0; y < drawnRows; y++) {
         for (int x = 0; x < cols; x++) {
             tile.setPosition(x * tileSize, y * tileSize);
 
-            if (maze[y][x] == '#') {
+            if (drawn[y][x] == '#') {
                 tile.setFillColor(sf::Color::Black);
             }
             else {
@@ -110,6 +182,12 @@ void MazeRenderer::render() {
             window.draw(tile);
         }
     }
+    if (drawnRows < rows) {
+        sf::RectangleShape rest(sf::Vector2f(cols * tileSize, (rows - drawnRows) * tileSize));
+        rest.setPosition(0, drawnRows * tileSize);
+        rest.setFillColor(sf::Color(128, 128, 128));
+        window.draw(rest);
+    }
 
     // animation
     if (animating) {
@@ -118,12 +196,7 @@ void MazeRenderer::render() {
                 sf::RectangleShape v(sf::Vector2f(tileSize, tileSize));
                 v.setPosition(point.second * tileSize, point.first * tileSize);
 
-                if (algorithms[selectedIndex] == "Dijkstra")
-                    v.setFillColor(sf::Color(100, 100, 255));
-                else if (algorithms[selectedIndex] == "BFS")
-                    v.setFillColor(sf::Color(255, 100, 100));
-                else if (algorithms[selectedIndex] == "DFS")
-                    v.setFillColor(sf::Color(255, 100, 255));
+                v.setFillColor(visitedColor());
                 window.draw(v);
             }
             for (const auto& point : pathPoints) {
@@ -139,12 +212,7 @@ void MazeRenderer::render() {
                 for (int i = 0; i <= visitedIndex; ++i) {
                     sf::RectangleShape v(sf::Vector2f(tileSize, tileSize));
                     v.setPosition(visitedPoints[i].second * tileSize, visitedPoints[i].first * tileSize);
-                    if (algorithms[selectedIndex] == "Dijkstra")
-                        v.setFillColor(sf::Color(100, 100, 255));
-                    else if (algorithms[selectedIndex] == "BFS")
-                        v.setFillColor(sf::Color(255, 100, 100));
-                    else if (algorithms[selectedIndex] == "DFS")
-                        v.setFillColor(sf::Color(255, 100, 255));
+                    v.setFillColor(visitedColor());
                     window.draw(v);
                 }
                                                           visitedIndex += 20;// turn this up or down to speed up or slow down the animation, 20 seems ok
@@ -182,26 +250,123 @@ void MazeRenderer::render() {
     window.draw(skipButtonText);
     window.draw(resetButton);
     window.draw(restButtonText);
+    window.draw(pruneButton);
+    window.draw(pruneButtonText);
+    window.draw(generatorBox);
+    window.draw(generatorText);
+    window.draw(braidBox);
+    window.draw(braidText);
     window.draw(dfs_key);
     window.draw(bfs_key);
     window.draw(dijkstra_key);
+    window.draw(astar_key);
     std::ostringstream oss;
     oss.precision(5);
-    oss << std::fixed << "Time: " << elapsedTime.count() << "s";
+    oss << std::fixed << "Time: " << elapsedTime.count() << "s" << resultNote;
     timerText.setString(oss.str());
     window.draw(timerText);
+    window.draw(seedText);
 
     window.display();
 }
+
+sf::Color MazeRenderer::visitedColor() const {
+    if (algorithms[selectedIndex] == "Dijkstra")
+        return sf::Color(100, 100, 255);
+    if (algorithms[selectedIndex] == "BFS")
+        return sf::Color(255, 100, 100);
+    if (algorithms[selectedIndex] == "DFS")
+        return sf::Color(255, 100, 255);
+    return sf::Color(255, 165, 0);
+}
+
+// The settings gen would build its next maze with
+MazeRenderer::MazeRequest MazeRenderer::requestFor(const MazeGenerator& gen) {
+    return { gen.getSeed(), gen.getAlgorithm(), gen.getBraid(), gen.getLoopDensity(), gen.getTileSize(), gen.getThreads() };
+}
+
+// Copies a generated maze into the form the renderer and solvers use
+MazeRenderer::BuiltMaze MazeRenderer::capture(const MazeGenerator& gen, MazeRequest request) {
+    BuiltMaze built;
+    built.request = request;
+    const auto& mazeLayout = gen.getMaze();
+    built.maze.reserve(mazeLayout.size());
+    for (const auto& row : mazeLayout)
+        built.maze.emplace_back(row.begin(), row.end());
+    built.components = ComponentLabeler(built.maze);
+    built.passages = gen.getPassages();
+    return built;
+}
+
+// Runs on the worker thread, so it uses its own generator. A cancelled build
+// comes back empty.
+MazeRenderer::BuiltMaze MazeRenderer::buildMaze(MazeRequest request, int rows, int cols, const std::atomic<bool>* cancel) {
+    MazeGenerator gen(rows, cols, request.seed);
+    gen.setAlgorithm(request.algorithm);
+    gen.setBraid(request.braid);
+    gen.setLoopDensity(request.loops);
+    gen.setTileSize(request.tileSize);
+    gen.setThreads(request.threads);
+    gen.setCancel(cancel);
+    if (!gen.generate())
+        return BuiltMaze{ request, {}, {} };
+    return capture(gen, request);
+}
+
+// Called once per frame. Never waits on the worker: it only picks up a
+// finished maze, swaps it in if it is the one that was asked for, and gives
+// the worker its next job.
 void MazeRenderer::updateMaze() {
-    generator.generate();
-    const auto& mazeLayout = generator.getMaze();
-    maze.clear();
-    for (const auto& row : mazeLayout) {
-        maze.emplace_back(row.begin(), row.end());
+    // a file being read gets the cores to itself, other mazes wait
+    if (loading) {
+        if (!loader->finished()) {
+            seedText.setString("Loading: " + std::to_string(loader->rowsReady()) + " / " + std::to_string(rows) + " rows");
+            return;
+        }
+        finishLoading();
+        if (!window.isOpen())
+            return;
+    }
+
+    // regions of the infinite maze are made on the spot, nothing to build
+    if (infinite)
+        return;
+
+    if (worker.valid() && worker.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        spare = std::make_unique<BuiltMaze>(worker.get());
+
+    if (spare && spare->request == wanted && shown != wanted) {
+        showMaze(std::move(*spare));
+        spare.reset();
+    }
+    if (shown != wanted)
+        seedText.setString("Seed: " + std::to_string(wanted.seed) + " (building...)");
+    if (worker.valid())
+        return;
+
+    if (shown != wanted) {
+        worker = std::async(std::launch::async, buildMaze, wanted, rows, cols, &stopBuilding);
     }
+    else if (speculate) {
+        MazeRequest next = wanted;
+        next.seed++;
+        if (!spare || spare->request != next)
+            worker = std::async(std::launch::async, buildMaze, next, rows, cols, &stopBuilding);
+    }
+}
+
+void MazeRenderer::showMaze(BuiltMaze&& built) {
+    maze.swap(built.maze);
+    components = std::move(built.components);
+    passages.swap(built.passages);
+    shown = built.request;
+    // keep the caller's generator describing what is on screen
+    generator.setSeed(shown.seed);
+    generator.setAlgorithm(shown.algorithm);
+    generator.setBraid(shown.braid);
     rows = maze.size();
     cols = maze[0].size();
+    prunedMaze.clear();
     visitedPoints.clear();
     pathPoints.clear();
     visitedIndex = 0;
@@ -209,4 +374,36 @@ void MazeRenderer::updateMaze() {
     animating = false;
     skipAnimation = false;
     elapsedTime = std::chrono::duration<float>::zero();
+    resultNote = "";
+    seedText.setString("Seed: " + std::to_string(shown.seed));
+    if (publisher)
+        publisher->publish(maze, shown.seed);
+}
+
+// The file has been read: it goes on screen like any other finished maze.
+// If it turned out to be broken (the loader said why) there is nothing to show.
+void MazeRenderer::finishLoading() {
+    loading = false;
+    if (!loader->wait()) {
+        window.close();
+        return;
+    }
+    showMaze({ loadedRequest, loader->takeMaze(), loader->takeComponents() });
+}
+
+void MazeRenderer::explore(const InfiniteMaze& maze, int64_t cellRow, int64_t cellCol) {
+    infinite = &maze;
+    regionRow = cellRow;
+    regionCol = cellCol;
+    showRegion();
+}
+
+void MazeRenderer::showRegion() {
+    BuiltMaze built;
+    built.request = shown;
+    built.request.seed = infinite->getSeed();
+    built.maze = infinite->region(regionRow, regionCol, (rows - 1) / 2, (cols - 1) / 2);
+    built.components = ComponentLabeler(built.maze);
+    showMaze(std::move(built));
+    seedText.setString("Seed: " + std::to_string(shown.seed) + " at " + std::to_string(regionRow) + ", " + std::to_string(regionCol));
 }
@@ -5,13 +5,50 @@
 #include <vector>
 #include <string>
 #include <chrono>
+#include <future>
+#include <memory>
+#include <atomic>
 #include "Algorithms.h"
 #include  "MazeGenerator.h"
+#include "ComponentLabeler.h"
+#include "DeadEndFiller.h"
+#include "AsyncMazeLoader.h"
+#include "SharedMaze.h"
+#include "InfiniteMaze.h"
 
 class MazeRenderer {
 private:
+    // Everything that decides which maze gets built, so a maze built in the
+    // background is the same kind the caller's generator would make
+    struct MazeRequest {
+        uint64_t seed;
+        MazeGenerator::Algorithm algorithm;
+        double braid;
+        double loops;
+        int tileSize;
+        int threads;
+        bool operator==(const MazeRequest& other) const {
+            return seed == other.seed && algorithm == other.algorithm && braid == other.braid &&
+                   loops == other.loops && tileSize == other.tileSize && threads == other.threads;
+        }
+        bool operator!=(const MazeRequest& other) const { return !(*this == other); }
+    };
+
+    // A finished maze, ready to be swapped in for the one on screen
+    struct BuiltMaze {
+        MazeRequest request;
+        std::vector<std::string> maze;
+        ComponentLabeler components;
+        std::vector<uint8_t> passages; // the generator's, empty for files and regions
+    };
+
     MazeGenerator& generator;
     std::vector<std::string> maze;
+    ComponentLabeler components;
+    // Passage masks of the maze on screen if a generator made it, which the
+    // solvers start from instead of the characters
+    std::vector<uint8_t> passages;
+    std::vector<std::string> prunedMaze; // dead ends filled, built on first use
     int tileSize;
     int rows, cols;
     sf::RenderWindow window;
@@ -25,20 +62,36 @@ private:
     sf::Text startButtonText;
     sf::Text skipButtonText;
     sf::Text timerText;
+    sf::Text seedText;
     sf::Text restButtonText;
+    sf::Text pruneButtonText;
+    sf::Text generatorText;
+    sf::Text braidText;
 
     sf::RectangleShape resetButton;
     sf::RectangleShape algoBox;
     sf::RectangleShape startButton;
     sf::RectangleShape skipButton;
+    sf::RectangleShape pruneButton;
+    sf::RectangleShape generatorBox;
+    sf::RectangleShape braidBox;
 
     sf::Text dfs_key;
     sf::Text bfs_key;
     sf::Text dijkstra_key;
+    sf::Text astar_key;
 
-    std::vector<std::string> algorithms = { "BFS", "DFS", "Dijkstra"};
+    std::vector<std::string> algorithms = { "BFS", "DFS", "Dijkstra", "A*" };
     int selectedIndex = 0;
 
+    std::vector<MazeGenerator::Algorithm> generators = {
+        MazeGenerator::Algorithm::Backtracker, MazeGenerator::Algorithm::Kruskal, MazeGenerator::Algorithm::Prim,
+        MazeGenerator::Algorithm::Wilson, MazeGenerator::Algorithm::Sidewinder, MazeGenerator::Algorithm::BinaryTree
+    };
+    int generatorIndex = 0;
+    std::vector<int> braidLevels = { 0, 25, 50, 100 }; // percent of dead ends removed
+    int braidIndex = 0;
+
     // Animation data
     std::vector<Algorithms::Point> visitedPoints;
     std::vector<Algorithms::Point> pathPoints;
@@ -46,25 +99,93 @@ private:
     int pathIndex = 0;
     bool animating = false;
     bool skipAnimation = false;
+    bool pruneDeadEnds = false;
 
 
     std::chrono::steady_clock::time_point startTime;
     std::chrono::duration<float> elapsedTime;
+    // Hard per-query latency budget. Solvers that run out of time hand back
+    // their best partial result instead of blocking the event loop.
+    std::chrono::milliseconds queryBudget{ 5 };
+    std::string resultNote;
+
+    // Mazes are built on a worker thread and swapped in once they are done,
+    // so the window keeps drawing the old one in the meantime. When the
+    // worker has nothing to do it builds the maze the next Reset will ask for.
+    // Closing the window sets stopBuilding, so it does not have to wait for a
+    // build nobody is going to look at.
+    MazeRequest wanted;
+    MazeRequest shown;
+    std::atomic<bool> stopBuilding{ false };
+    std::future<BuiltMaze> worker;
+    std::unique_ptr<BuiltMaze> spare;
+    bool speculate = true;
+
+    // A maze file still being read. Its rows are drawn as they come in and
+    // solving waits until it is done. Kept afterwards, since the labels of
+    // a sidecar index point into it.
+    std::unique_ptr<AsyncMazeLoader> loader;
+    bool loading = false;
+    MazeRequest loadedRequest;
+
+    // Not owned. While set, the window shows a window-sized region of it
+    // starting at cell (regionRow, regionCol) instead of a finite maze, and
+    // the arrow keys move the region around.
+    const InfiniteMaze* infinite = nullptr;
+    int64_t regionRow = 0, regionCol = 0;
+
+    // Not owned. Every maze that goes on screen is published to it too, so
+    // solver processes always see the one in the window.
+    SharedMazePublisher* publisher;
+
+    static MazeRequest requestFor(const MazeGenerator& gen);
+    static BuiltMaze capture(const MazeGenerator& gen, MazeRequest request);
+    static BuiltMaze buildMaze(MazeRequest request, int rows, int cols, const std::atomic<bool>* cancel);
     void updateMaze();
+    void showMaze(BuiltMaze&& built);
+    void finishLoading();
+    void showRegion();
     void processEvents();
     void render();
+    sf::Color visitedColor() const;
 
 public:
-        MazeRenderer(MazeGenerator& gen, int tileSize, int windowWidth, int windowHeight)
+        // mazeFile, if given, is a maze file being read, which is shown
+        // (as far as it has got) instead of the generator's maze.
+        // sharedAs, if given, gets every maze shown (see SharedMaze.h).
+        MazeRenderer(MazeGenerator& gen, int tileSize, int windowWidth, int windowHeight,
+                     std::unique_ptr<AsyncMazeLoader> mazeFile = nullptr, SharedMazePublisher* sharedAs = nullptr)
         : generator(gen),
         tileSize(tileSize),
         window(sf::VideoMode(1800, 800), "Maze Solver!"),
-        view(sf::FloatRect(0, 0, 1555, windowHeight))
+        view(sf::FloatRect(0, 0, 1555, windowHeight)),
+        loader(std::move(mazeFile)),
+        publisher(sharedAs)
 
     {
-        updateMaze();
-        rows = maze.size();
-        cols = maze[0].size();
+        wanted = requestFor(generator);
+        for (size_t i = 0; i < generators.size(); i++) {
+            if (generators[i] == wanted.algorithm)
+                generatorIndex = static_cast<int>(i);
+        }
+        for (size_t i = 0; i < braidLevels.size(); i++) {
+            if (braidLevels[i] == static_cast<int>(wanted.braid * 100 + 0.5))
+                braidIndex = static_cast<int>(i);
+        }
+        if (loader) {
+            loading = true;
+            loadedRequest = wanted;
+            shown = wanted;
+            rows = loader->getRows();
+            cols = loader->getCols();
+        }
+        else {
+            if (generator.getCellRows() == 0)
+                generator.generate();
+            showMaze(capture(generator, wanted));
+            rows = maze.size();
+            cols = maze[0].size();
+        }
         window.setView(view);
 
         window.setFramerateLimit(60);
@@ -128,6 +249,45 @@ public:
         timerText.setPosition(sidebarX + 200, 300);
         timerText.setString("Time: 0.0s");
 
+        seedText.setFont(font);
+        seedText.setCharacterSize(25);
+        seedText.setFillColor(sf::Color::Black);
+        seedText.setPosition(sidebarX + 200, 350);
+
+        pruneButton.setSize(sf::Vector2f(260, 40));
+        pruneButton.setPosition(sidebarX + 200, 620);
+        pruneButton.setFillColor(sf::Color(100, 100, 200));
+
+        pruneButtonText.setFont(font);
+        pruneButtonText.setString("Fill Dead Ends: Off");
+        pruneButtonText.setCharacterSize(25);
+        pruneButtonText.setFillColor(sf::Color::White);
+        pruneButtonText.setPosition(pruneButton.getPosition().x + 40, pruneButton.getPosition().y + 8);
+
+        generatorBox.setSize(sf::Vector2f(260, 40));
+        generatorBox.setPosition(sidebarX + 200, 680);
+        generatorBox.setFillColor(sf::Color(245, 245, 245));
+        generatorBox.setOutlineThickness(2);
+        generatorBox.setOutlineColor(sf::Color::Black);
+
+        generatorText.setFont(font);
+        generatorText.setCharacterSize(25);
+        generatorText.setFillColor(sf::Color::Black);
+        generatorText.setString(std::string("Maze: ") + MazeGenerator::algorithmName(generator.getAlgorithm()));
+        generatorText.setPosition(generatorBox.getPosition().x + 10, generatorBox.getPosition().y + 8);
+
+        braidBox.setSize(sf::Vector2f(260, 40));
+        braidBox.setPosition(sidebarX + 200, 740);
+        braidBox.setFillColor(sf::Color(245, 245, 245));
+        braidBox.setOutlineThickness(2);
+        braidBox.setOutlineColor(sf::Color::Black);
+
+        braidText.setFont(font);
+        braidText.setCharacterSize(25);
+        braidText.setFillColor(sf::Color::Black);
+        braidText.setString("Loops (braid): " + std::to_string(static_cast<int>(wanted.braid * 100 + 0.5)) + "%");
+        braidText.setPosition(braidBox.getPosition().x + 10, braidBox.getPosition().y + 8);
+
         dfs_key.setFont(font);
         dfs_key.setString("DFS: PURPLE");
         dfs_key.setCharacterSize(50);
@@ -146,6 +306,12 @@ public:
         dijkstra_key.setFillColor(sf::Color(100, 100, 255));
         dijkstra_key.setPosition(sidebarX+200, 500);
 
+        astar_key.setFont(font);
+        astar_key.setString("A*: ORANGE");
+        astar_key.setCharacterSize(50);
+        astar_key.setFillColor(sf::Color(255, 165, 0));
+        astar_key.setPosition(sidebarX+200, 550);
+
         visitedIndex = 0;
         pathIndex = 0;
         animating = false;
@@ -154,7 +320,14 @@ public:
 
 
     }
+    // Cancels the background build instead of waiting for it to finish
+    ~MazeRenderer();
+
+    // Shows the infinite maze from cell (cellRow, cellCol) on, in place of
+    // the generator's maze. The maze has to outlive the renderer.
+    void explore(const InfiniteMaze& maze, int64_t cellRow, int64_t cellCol);
 
     void run();
 };
 
+#endif
@@ -0,0 +1,146 @@
+#include "PackedMazeGenerator.h"
+#include <thread>
+#include <algorithm>
+
+namespace {
+    // Spreads the 32 bits of v out to the even bit positions of a word
+    // Reference -> https://graphics.stanford.edu/~seander/bithacks.html#InterleaveBMN
+    uint64_t spread(uint64_t v) {
+        v &= 0xFFFFFFFFull;
+        v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+        v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+        v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+        v = (v | (v << 2)) & 0x3333333333333333ull;
+        v = (v | (v << 1)) & 0x5555555555555555ull;
+        return v;
+    }
+
+    // OR of x from the start of each segment up to and including every bit.
+    // A segment starts at every set bit of starts. Doubling steps, like a
+    // parallel prefix sum that is not allowed to cross a start.
+    uint64_t segmentedPrefixOr(uint64_t x, uint64_t starts) {
+        uint64_t joined = ~starts;
+        for (int k = 1; k < 64; k <<= 1) {
+            x |= (x << k) & joined;
+            joined &= joined << k;
+        }
+        return x;
+    }
+}
+
+PackedMazeGenerator::PackedMazeGenerator(int rows, int cols, uint64_t intSeed)
+    : cellRows(rows / 2), cellCols(cols / 2), seed(intSeed) {}
+
+bool PackedMazeGenerator::supports(MazeGenerator::Algorithm algorithm) {
+    return algorithm == MazeGenerator::Algorithm::Sidewinder || algorithm == MazeGenerator::Algorithm::BinaryTree;
+}
+
+void PackedMazeGenerator::setAlgorithm(MazeGenerator::Algorithm newAlgorithm) {
+    if (supports(newAlgorithm))
+        algorithm = newAlgorithm;
+}
+
+MazeGenerator::Algorithm PackedMazeGenerator::getAlgorithm() const {
+    return algorithm;
+}
+
+void PackedMazeGenerator::generate(int threads) {
+    grid = BitGrid(2 * cellRows + 1, 2 * cellCols + 1);
+    if (cellRows == 0 || cellCols == 0)
+        return;
+
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::min(threads, cellRows);
+    int band = (cellRows + threads - 1) / threads;
+
+    // Cell row x only writes character rows 2x and 2x + 1, so bands never share a word
+    auto generateBand = [this](int first, int last) {
+        for (int x = first; x < last; x++)
+            generateRow(x);
+    };
+    std::vector<std::thread> pool;
+    for (int first = 0; first < cellRows; first += band)
+        pool.emplace_back(generateBand, first, std::min(cellRows, first + band));
+    for (auto& t : pool)
+        t.join();
+
+    // entrance and exit, same spots as MazeGenerator
+    grid.set(0, 1, true);
+    grid.set(2 * cellRows, 2 * cellCols - 1, true);
+}
+
+// Works out the east and north passages of cell row x one 64 cell word at a
+// time and writes them out as character rows 2x + 1 and 2x.
+//
+// Character row 2x + 1 has cell j at column 2j + 1 and its east passage at
+// 2j + 2, so 32 cells fill one output word: spread() the cell bits to the odd
+// positions and the east bits one further. The east passage of the 32nd cell
+// spills over into bit 0 of the next word.
+void PackedMazeGenerator::generateRow(int x) {
+    Rng rng(Rng::mix(seed, static_cast<uint64_t>(x)));
+    uint64_t* cellRow = grid.row(2 * x + 1);
+    uint64_t* wallRow = grid.row(2 * x);
+    int stride = grid.wordsPerRow();
+    int words = (cellCols + 63) / 64;
+    bool topRow = x == 0;
+
+    bool previousEnded = true;   // the run before this word ended at its last cell
+    bool previousChosen = false; // the unfinished run already has its north cell
+    uint64_t spill = 0;
+
+    for (int w = 0; w < words; w++) {
+        int count = std::min(64, cellCols - w * 64);
+        uint64_t valid = count == 64 ? ~0ull : (uint64_t(1) << count) - 1;
+        // the last cell of the row never opens east
+        uint64_t lastCell = w == words - 1 ? uint64_t(1) << (count - 1) : 0;
+        uint64_t canEast = valid & ~lastCell;
+
+        uint64_t east, north;
+        if (topRow) {
+            east = canEast;
+            north = 0;
+        }
+        else if (algorithm == MazeGenerator::Algorithm::BinaryTree) {
+            // one random bit per cell: east if set, north otherwise
+            east = rng.next() & canEast;
+            north = valid & ~east;
+        }
+        else {
+            // Sidewinder: a run ends wherever a cell does not go east. Each
+            // run opens north at the first cell that has a random bit set,
+            // or at its last cell if none has.
+            east = rng.next() & canEast;
+            uint64_t ends = valid & ~east;
+            uint64_t starts = (ends << 1) | (previousEnded ? 1 : 0);
+            uint64_t candidates = (rng.next() | ends) & valid;
+            uint64_t seen = segmentedPrefixOr(candidates, starts);
+            // candidates earlier in the same run, including the part of the
+            // run that started in the previous word
+            uint64_t before = (seen << 1) & ~starts;
+            if (previousChosen)
+                before |= (starts & (0 - starts)) - 1;
+            north = candidates & ~before;
+            previousChosen = ((seen | before) >> 63) & 1;
+            previousEnded = (ends >> 63) & 1;
+        }
+
+        for (int half = 0; half < 2; half++) {
+            int out = 2 * w + half;
+            if (out >= stride)
+                break;
+            int shift = half * 32;
+            cellRow[out] = (spread(valid >> shift) << 1) | (spread(east >> shift) << 2) | spill;
+            spill = (east >> (shift + 31)) & 1;
+            wallRow[out] = spread(north >> shift) << 1;
+        }
+    }
+}
+
+const BitGrid& PackedMazeGenerator::getGrid() const {
+    return grid;
+}
+
+uint64_t PackedMazeGenerator::getSeed() const {
+    return seed;
+}
@@ -0,0 +1,45 @@
+#ifndef PACKED_MAZE_GENERATOR_H
+#define PACKED_MAZE_GENERATOR_H
+
+#include <cstdint>
+#include "BitGrid.h"
+#include "MazeGenerator.h"
+#include "Rng.h"
+
+// Bulk generator for huge stress-test mazes. Sidewinder and Binary Tree
+// decide every cell of a row on their own, so instead of carving cell by
+// cell this works on 64 cells at a time: one random word gives 64 east/north
+// choices, a few shifts and masks turn them into passages, and the result is
+// written straight into a BitGrid in the usual 2x+1 character layout.
+//
+// Every cell row draws from its own stream, Rng::mix(seed, row), so row bands
+// are generated on separate threads and the maze does not depend on how many
+// threads were used. It is not the same maze MazeGenerator gives for the same
+// seed, and Sidewinder picks the cell that opens north with a bias towards
+// the start of each run.
+class PackedMazeGenerator {
+public:
+    // rows and cols are character dimensions, like MazeGenerator
+    PackedMazeGenerator(int rows, int cols, uint64_t seed = Rng::randomSeed());
+
+    static bool supports(MazeGenerator::Algorithm algorithm);
+    // Only Sidewinder and BinaryTree, anything else is ignored
+    void setAlgorithm(MazeGenerator::Algorithm algorithm);
+    MazeGenerator::Algorithm getAlgorithm() const;
+
+    // threads <= 0 means use std::thread::hardware_concurrency()
+    void generate(int threads = 0);
+
+    const BitGrid& getGrid() const;
+    uint64_t getSeed() const;
+
+private:
+    int cellRows, cellCols;
+    uint64_t seed;
+    MazeGenerator::Algorithm algorithm = MazeGenerator::Algorithm::Sidewinder;
+    BitGrid grid;
+
+    void generateRow(int x);
+};
+
+#endif
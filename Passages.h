@@ -0,0 +1,21 @@
+#ifndef PASSAGES_H
+#define PASSAGES_H
+
+#include <cstdint>
+
+// Bit flags for the open sides of a maze cell. A cell's passage mask is the
+// OR of the directions you can move in from it. The order matches the
+// solver's direction table (up, down, left, right).
+enum Passage : uint8_t {
+    North = 1,
+    South = 2,
+    West = 4,
+    East = 8
+};
+
+// Passage on the other side of the same wall
+inline uint8_t opposite(uint8_t passage) {
+    return (passage & (North | West)) ? static_cast<uint8_t>(passage << 1) : static_cast<uint8_t>(passage >> 1);
+}
+
+#endif
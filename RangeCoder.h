@@ -0,0 +1,106 @@
+#ifndef RANGE_CODER_H
+#define RANGE_CODER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Adaptive binary range coder, the one LZMA uses. Every bit is coded with a
+// probability that learns from the bits coded with it before, so anything
+// a model can predict well costs far less than a bit.
+// Reference -> https://en.wikipedia.org/wiki/Range_coding
+// Reference -> https://www.7-zip.org/sdk.html (LzmaEnc.c / LzmaDec.c)
+
+// Probability that the next bit is 0, out of 2048
+struct BitModel {
+    uint16_t p0 = 1024;
+};
+
+class RangeEncoder {
+public:
+    explicit RangeEncoder(std::vector<uint8_t>& out) : out(out) {}
+
+    void encode(BitModel& model, int bit) {
+        uint32_t bound = (range >> 11) * model.p0;
+        if (bit == 0) {
+            range = bound;
+            model.p0 += (2048 - model.p0) >> 5;
+        }
+        else {
+            low += bound;
+            range -= bound;
+            model.p0 -= model.p0 >> 5;
+        }
+        while (range < (1u << 24)) {
+            range <<= 8;
+            shiftLow();
+        }
+    }
+
+    void finish() {
+        for (int i = 0; i < 5; i++)
+            shiftLow();
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t low = 0;
+    uint32_t range = 0xFFFFFFFFu;
+    uint8_t cache = 0;
+    uint64_t cacheSize = 1;
+
+    // Bytes are held back while they could still change because of a carry
+    void shiftLow() {
+        if (static_cast<uint32_t>(low) < 0xFF000000u || (low >> 32) != 0) {
+            uint8_t carry = static_cast<uint8_t>(low >> 32);
+            uint8_t pending = cache;
+            do {
+                out.push_back(static_cast<uint8_t>(pending + carry));
+                pending = 0xFF;
+            } while (--cacheSize != 0);
+            cache = static_cast<uint8_t>(low >> 24);
+        }
+        cacheSize++;
+        low = (low & 0x00FFFFFFu) << 8;
+    }
+};
+
+class RangeDecoder {
+public:
+    RangeDecoder(const uint8_t* data, size_t size) : data(data), end(data + size) {
+        for (int i = 0; i < 5; i++)
+            code = (code << 8) | next();
+    }
+
+    int decode(BitModel& model) {
+        uint32_t bound = (range >> 11) * model.p0;
+        int bit;
+        if (code < bound) {
+            range = bound;
+            model.p0 += (2048 - model.p0) >> 5;
+            bit = 0;
+        }
+        else {
+            code -= bound;
+            range -= bound;
+            model.p0 -= model.p0 >> 5;
+            bit = 1;
+        }
+        while (range < (1u << 24)) {
+            range <<= 8;
+            code = (code << 8) | next();
+        }
+        return bit;
+    }
+
+private:
+    const uint8_t* data;
+    const uint8_t* end;
+    uint32_t code = 0;
+    uint32_t range = 0xFFFFFFFFu;
+
+    // a damaged block decodes to garbage instead of reading past the end
+    uint8_t next() { return data < end ? *data++ : 0; }
+};
+
+#endif
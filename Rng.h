@@ -0,0 +1,88 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <charconv>
+
+// Small, fast, seedable random generator for the maze generators.
+// xoshiro256** by Blackman and Vigna, state filled from the seed with splitmix64.
+// Reference -> https://prng.di.unimi.it/
+// Same seed, same sequence, on every platform (unlike std::uniform_int_distribution).
+class Rng {
+public:
+    explicit Rng(uint64_t seed) {
+        for (auto& word : s)
+            word = splitmix64(seed);
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform integer in [0, n) without modulo bias, Lemire's multiply-shift method
+    // Reference -> https://arxiv.org/abs/1805.10941
+    uint32_t bounded(uint32_t n) {
+        uint64_t m = (next() >> 32) * n;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < n) {
+            uint32_t threshold = static_cast<uint32_t>(-n) % n;
+            while (low < threshold) {
+                m = (next() >> 32) * n;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    // Uniform double in [0, 1) from the top 53 bits
+    double uniform() {
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Fresh seed for when the caller did not ask for a specific one
+    static uint64_t randomSeed() {
+        std::random_device rd;
+        return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+    }
+
+    // Seed written as a plain decimal number (command line, file headers).
+    // False for anything else, including numbers too big for 64 bits.
+    static bool parseSeed(const std::string& text, uint64_t& seed) {
+        if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+        auto result = std::from_chars(text.data(), text.data() + text.size(), seed);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // Mixes an extra value into a seed, used to give every tile its own stream
+    static uint64_t mix(uint64_t seed, uint64_t value) {
+        uint64_t x = seed ^ (value * 0xD1B54A32D192ED03ull);
+        return splitmix64(x);
+    }
+
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    static uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+#endif
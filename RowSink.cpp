@@ -0,0 +1,35 @@
+#include "RowSink.h"
+#include <iostream>
+
+FileRowSink::FileRowSink(const std::string& filename, const std::string& header) : filename(filename), outfile(filename) {
+    if (!outfile.isOpen())
+        return;
+    if (!header.empty()) {
+        std::string line = "; " + header + "\n";
+        outfile.write(line.data(), line.size());
+    }
+}
+
+bool FileRowSink::isOpen() const {
+    return outfile.isOpen();
+}
+
+void FileRowSink::consumeRow(const std::string& row) {
+    outfile.write(row.data(), row.size());
+    outfile.put('\n');
+}
+
+bool FileRowSink::finish() {
+    if (outfile.close())
+        return true;
+    std::cerr << "Something went wrong writing " << filename << std::endl;
+    return false;
+}
+
+void GridRowSink::consumeRow(const std::string& row) {
+    maze.push_back(row);
+}
+
+const std::vector<std::string>& GridRowSink::getMaze() const {
+    return maze;
+}
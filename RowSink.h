@@ -0,0 +1,43 @@
+#ifndef ROW_SINK_H
+#define ROW_SINK_H
+
+#include <vector>
+#include <string>
+#include "BufferedFileWriter.h"
+
+// Receives a maze one character row at a time, top to bottom. Lets
+// streaming generators hand rows to a file, solver or renderer without
+// the whole maze ever being in memory.
+class RowSink {
+public:
+    virtual ~RowSink() = default;
+    virtual void consumeRow(const std::string& row) = 0;
+};
+
+// Writes rows to a text file in the same format as MazeGenerator::saveToFile
+class FileRowSink : public RowSink {
+public:
+    // header is written as a "; " comment line first if it is not empty
+    FileRowSink(const std::string& filename, const std::string& header = "");
+    bool isOpen() const;
+    void consumeRow(const std::string& row) override;
+    // Writes out what is left. Prints what went wrong and returns false if
+    // any of it could not be written, e.g. because the disk is full.
+    bool finish();
+
+private:
+    std::string filename;
+    BufferedFileWriter outfile;
+};
+
+// Keeps every row, for handing a streamed maze to the solver or renderer
+class GridRowSink : public RowSink {
+public:
+    void consumeRow(const std::string& row) override;
+    const std::vector<std::string>& getMaze() const;
+
+private:
+    std::vector<std::string> maze;
+};
+
+#endif
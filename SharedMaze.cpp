@@ -0,0 +1,218 @@
+#include "SharedMaze.h"
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace {
+    const char controlMagic[4] = { 'M', 'A', 'Z', 'C' };
+    const char mazeMagic[4] = { 'M', 'A', 'Z', 'M' };
+    const uint32_t formatVersion = 2;
+    // a publisher can swap segments between a reader looking up the
+    // generation and opening it, so readers try again a few times
+    const int openAttempts = 5;
+
+    struct ControlBlock {
+        char magic[4];
+        uint32_t version;
+        std::atomic<uint64_t> generation;
+        std::atomic<uint64_t> owner; // process id of the publisher, 0 once it is gone
+    };
+
+    struct MazeHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t generation;
+        uint64_t seed;
+        uint32_t rows, cols;
+        uint64_t stride;     // bytes per row, '\n' included
+        uint64_t dataOffset; // where row 0 starts
+    };
+
+    const size_t headerSize = 64;
+    static_assert(sizeof(MazeHeader) <= headerSize, "the rows start after the header");
+    // readers map the control block read-only and only ever load from it,
+    // which needs an atomic that is a plain memory word
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "the generation is shared between processes");
+
+    std::string segmentName(const std::string& name, uint64_t generation) {
+        return name + "." + std::to_string(generation);
+    }
+}
+
+SharedMazePublisher::SharedMazePublisher(const std::string& name) : name(name) {
+    uint64_t self = SharedMemory::processId();
+    if (control.create(name, sizeof(ControlBlock), true)) {
+        new (control.writable()) ControlBlock{ { 'M', 'A', 'Z', 'C' }, formatVersion, { 0 }, { self } };
+        return;
+    }
+    if (!control.taken())
+        return;
+
+    // Somebody has the name already. Fine if it was a publisher that has
+    // since gone (crashed, or readers still hold the name on Windows), then
+    // carry on counting from where it got to. Whoever swaps their own id in
+    // first gets it, so two processes taking over at once can't both win.
+    if (control.open(name, true) && control.size() >= sizeof(ControlBlock) &&
+        std::memcmp(control.data(), controlMagic, 4) == 0 &&
+        reinterpret_cast<const ControlBlock*>(control.data())->version == formatVersion) {
+        ControlBlock* block = reinterpret_cast<ControlBlock*>(control.writable());
+        uint64_t previous = block->owner.load();
+        if (!SharedMemory::processAlive(previous) && block->owner.compare_exchange_strong(previous, self)) {
+            generation = block->generation.load();
+            // its last maze never got unlinked
+            SharedMemory::remove(segmentName(name, generation));
+            return;
+        }
+    }
+    // also ends up here if the block is there but not filled in yet, which
+    // means another publisher is starting up right now
+    control.close();
+    std::cerr << "A maze is already being published as " << name << " by another process" << std::endl;
+}
+
+SharedMazePublisher::~SharedMazePublisher() {
+    if (!control.isOpen())
+        return;
+    reinterpret_cast<ControlBlock*>(control.writable())->owner.store(0);
+    current.unlink();
+    control.unlink();
+}
+
+bool SharedMazePublisher::isOpen() const {
+    return control.isOpen();
+}
+
+bool SharedMazePublisher::publish(const std::vector<std::string>& maze, uint64_t seed) {
+    int rows = static_cast<int>(maze.size());
+    int cols = rows > 0 ? static_cast<int>(maze[0].size()) : 0;
+    for (const auto& row : maze) {
+        if (static_cast<int>(row.size()) != cols) {
+            std::cerr << "Only a rectangular maze can be published" << std::endl;
+            return false;
+        }
+    }
+    return publishGrid(maze, rows, cols, seed);
+}
+
+bool SharedMazePublisher::publish(const GridView& maze, uint64_t seed) {
+    return publishGrid(maze, maze.getRows(), maze.getCols(), seed);
+}
+
+template <typename Grid>
+bool SharedMazePublisher::publishGrid(const Grid& maze, int rows, int cols, uint64_t seed) {
+    if (!control.isOpen())
+        return false;
+
+    uint64_t next = generation + 1;
+    size_t stride = static_cast<size_t>(cols) + 1;
+    SharedMemory segment;
+    if (!segment.create(segmentName(name, next), headerSize + static_cast<size_t>(rows) * stride))
+        return false;
+
+    char* out = segment.writable();
+    MazeHeader header = {};
+    std::memcpy(header.magic, mazeMagic, 4);
+    header.version = formatVersion;
+    header.generation = next;
+    header.seed = seed;
+    header.rows = static_cast<uint32_t>(rows);
+    header.cols = static_cast<uint32_t>(cols);
+    header.stride = stride;
+    header.dataOffset = headerSize;
+    std::memcpy(out, &header, sizeof(header));
+    for (int r = 0; r < rows; r++) {
+        char* row = out + headerSize + static_cast<size_t>(r) * stride;
+        if (cols > 0)
+            std::memcpy(row, &maze[r][0], cols);
+        row[cols] = '\n';
+    }
+
+    // everything above is visible to a reader that sees the new generation
+    ControlBlock* block = reinterpret_cast<ControlBlock*>(control.writable());
+    block->generation.store(next, std::memory_order_release);
+
+    current.unlink();
+    current = std::move(segment);
+    generation = next;
+    return true;
+}
+
+uint64_t SharedMazePublisher::getGeneration() const {
+    return generation;
+}
+
+bool SharedMazeReader::open(const std::string& mazeName) {
+    name = mazeName;
+    segment.close();
+    view = GridView();
+    generation = 0;
+
+    if (!control.open(name) || control.size() < sizeof(ControlBlock) ||
+        std::memcmp(control.data(), controlMagic, 4) != 0 ||
+        reinterpret_cast<const ControlBlock*>(control.data())->version != formatVersion) {
+        control.close();
+        std::cerr << "No maze is published as " << name << std::endl;
+        return false;
+    }
+    for (int attempt = 0; attempt < openAttempts; attempt++) {
+        uint64_t latest = publishedGeneration();
+        if (latest != 0 && mapGeneration(latest))
+            return true;
+    }
+    std::cerr << "Something went wrong opening the maze published as " << name << std::endl;
+    return false;
+}
+
+uint64_t SharedMazeReader::publishedGeneration() const {
+    if (!control.isOpen())
+        return 0;
+    return reinterpret_cast<const ControlBlock*>(control.data())->generation.load(std::memory_order_acquire);
+}
+
+bool SharedMazeReader::mapGeneration(uint64_t wanted) {
+    SharedMemory next;
+    if (!next.open(segmentName(name, wanted)) || next.size() < headerSize)
+        return false;
+    MazeHeader header;
+    std::memcpy(&header, next.data(), sizeof(header));
+    // checked with division and subtraction so no product or sum can wrap around
+    if (std::memcmp(header.magic, mazeMagic, 4) != 0 || header.version != formatVersion || header.generation != wanted ||
+        header.rows > INT_MAX || header.cols > INT_MAX || header.stride < header.cols || header.stride == 0 ||
+        header.dataOffset > next.size() || header.rows > (next.size() - header.dataOffset) / header.stride)
+        return false;
+
+    segment = std::move(next);
+    view = GridView(segment.data() + header.dataOffset, static_cast<int>(header.rows), static_cast<int>(header.cols), header.stride);
+    generation = wanted;
+    seed = header.seed;
+    return true;
+}
+
+const GridView& SharedMazeReader::getView() const {
+    return view;
+}
+
+uint64_t SharedMazeReader::getGeneration() const {
+    return generation;
+}
+
+uint64_t SharedMazeReader::getSeed() const {
+    return seed;
+}
+
+bool SharedMazeReader::isStale() const {
+    return publishedGeneration() != generation;
+}
+
+bool SharedMazeReader::refresh() {
+    for (int attempt = 0; attempt < openAttempts; attempt++) {
+        uint64_t latest = publishedGeneration();
+        if (latest == generation || latest == 0)
+            return false;
+        if (mapGeneration(latest))
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,84 @@
+#ifndef SHARED_MAZE_H
+#define SHARED_MAZE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "SharedMemory.h"
+#include "GridView.h"
+
+// Hands one maze to any number of solver processes without each of them
+// generating or parsing its own copy. The publisher writes the maze into
+// shared memory once; readers map it read-only and get a GridView straight
+// into it, which Algorithms takes as is.
+//
+// A name is really two segments:
+//  <name>        tiny control block holding the current generation
+//  <name>.<gen>  the maze itself: a 64 byte binary header, then the rows,
+//                each ending in '\n' like a maze text file, so they can be
+//                looked at with e.g. tail -c +65 /dev/shm/<name>.<gen>
+//
+// Every publish() writes a complete new maze segment and only then bumps
+// the generation, so a reader never sees half a maze. The old segment
+// loses its name but lives on until the last reader lets go of it, so a
+// reader keeps working on the maze it has until it calls refresh().
+class SharedMazePublisher {
+public:
+    // Refuses (and prints why) if another running process is already
+    // publishing under that name; takes over from one that died
+    explicit SharedMazePublisher(const std::string& name);
+    // Withdraws the maze; readers that have it mapped keep their copy
+    ~SharedMazePublisher();
+
+    SharedMazePublisher(const SharedMazePublisher&) = delete;
+    SharedMazePublisher& operator=(const SharedMazePublisher&) = delete;
+
+    // False if the name could not be claimed
+    bool isOpen() const;
+
+    // Prints what went wrong and returns false if it could not be published
+    bool publish(const std::vector<std::string>& maze, uint64_t seed);
+    bool publish(const GridView& maze, uint64_t seed);
+
+    // 0 until the first publish()
+    uint64_t getGeneration() const;
+
+private:
+    std::string name;
+    SharedMemory control;
+    SharedMemory current;
+    uint64_t generation = 0;
+
+    template <typename Grid>
+    bool publishGrid(const Grid& maze, int rows, int cols, uint64_t seed);
+};
+
+class SharedMazeReader {
+public:
+    // Prints what went wrong and returns false if nothing is published
+    // under that name (yet)
+    bool open(const std::string& name);
+
+    // Points into the shared memory; valid until the next open() or refresh()
+    const GridView& getView() const;
+    uint64_t getGeneration() const;
+    uint64_t getSeed() const;
+
+    // True once the publisher has put out a newer maze
+    bool isStale() const;
+    // Switches to the newest maze. Returns true if it changed.
+    bool refresh();
+
+private:
+    std::string name;
+    SharedMemory control;
+    SharedMemory segment;
+    GridView view;
+    uint64_t generation = 0;
+    uint64_t seed = 0;
+
+    uint64_t publishedGeneration() const;
+    bool mapGeneration(uint64_t wanted);
+};
+
+#endif
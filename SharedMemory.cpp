@@ -0,0 +1,193 @@
+#include "SharedMemory.h"
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <signal.h>
+#include <cerrno>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    std::string systemName(const std::string& name) {
+#ifdef _WIN32
+        return "Local\\" + name;
+#else
+        return "/" + name;
+#endif
+    }
+}
+
+SharedMemory::~SharedMemory() {
+    close();
+}
+
+SharedMemory::SharedMemory(SharedMemory&& other) noexcept
+    : name(std::move(other.name)), bytes(std::exchange(other.bytes, nullptr)),
+      length(std::exchange(other.length, 0)), owner(std::exchange(other.owner, false)),
+      nameTaken(std::exchange(other.nameTaken, false)) {}
+
+SharedMemory& SharedMemory::operator=(SharedMemory&& other) noexcept {
+    if (this != &other) {
+        close();
+        name = std::move(other.name);
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+        owner = std::exchange(other.owner, false);
+        nameTaken = std::exchange(other.nameTaken, false);
+    }
+    return *this;
+}
+
+bool SharedMemory::create(const std::string& segmentName, size_t size, bool exclusive) {
+    close();
+    nameTaken = false;
+    name = systemName(segmentName);
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(static_cast<unsigned long long>(size) >> 32), static_cast<DWORD>(size), name.c_str());
+    if (mapping && exclusive && GetLastError() == ERROR_ALREADY_EXISTS) {
+        CloseHandle(mapping);
+        nameTaken = true;
+        return false;
+    }
+    if (mapping) {
+        // the view keeps the segment (and its name) alive
+        bytes = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size));
+        CloseHandle(mapping);
+    }
+#else
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | (exclusive ? O_EXCL : 0), 0644);
+    if (fd < 0 && exclusive && errno == EEXIST) {
+        nameTaken = true;
+        return false;
+    }
+    if (fd >= 0) {
+        if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+            void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (view != MAP_FAILED)
+                bytes = static_cast<char*>(view);
+        }
+        ::close(fd);
+    }
+#endif
+    if (!bytes) {
+        std::cerr << "Something went wrong creating shared memory " << segmentName << std::endl;
+        return false;
+    }
+    length = size;
+    owner = true;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& segmentName, bool writable) {
+    close();
+    name = systemName(segmentName);
+#ifdef _WIN32
+    DWORD access = writable ? FILE_MAP_WRITE : FILE_MAP_READ;
+    HANDLE mapping = OpenFileMappingA(access, FALSE, name.c_str());
+    if (!mapping)
+        return false;
+    bytes = static_cast<char*>(MapViewOfFile(mapping, access, 0, 0, 0));
+    CloseHandle(mapping);
+    MEMORY_BASIC_INFORMATION info;
+    if (bytes && VirtualQuery(bytes, &info, sizeof(info)))
+        length = info.RegionSize;
+#else
+    int fd = shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        length = static_cast<size_t>(info.st_size);
+        void* view = mmap(nullptr, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (view != MAP_FAILED)
+            bytes = static_cast<char*>(view);
+    }
+    ::close(fd);
+#endif
+    if (!bytes) {
+        length = 0;
+        return false;
+    }
+    owner = writable;
+    return true;
+}
+
+bool SharedMemory::taken() const {
+    return nameTaken;
+}
+
+bool SharedMemory::isOpen() const {
+    return bytes != nullptr;
+}
+
+const char* SharedMemory::data() const {
+    return bytes;
+}
+
+char* SharedMemory::writable() const {
+    return owner ? bytes : nullptr;
+}
+
+size_t SharedMemory::size() const {
+    return length;
+}
+
+void SharedMemory::unlink() {
+#ifndef _WIN32
+    if (owner && !name.empty())
+        shm_unlink(name.c_str());
+#endif
+}
+
+void SharedMemory::remove(const std::string& segmentName) {
+#ifndef _WIN32
+    shm_unlink(systemName(segmentName).c_str());
+#endif
+}
+
+uint64_t SharedMemory::processId() {
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#else
+    return static_cast<uint64_t>(getpid());
+#endif
+}
+
+bool SharedMemory::processAlive(uint64_t id) {
+    if (id == 0)
+        return false;
+#ifdef _WIN32
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(id));
+    if (!process)
+        return GetLastError() == ERROR_ACCESS_DENIED;
+    bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    return running;
+#else
+    // EPERM means it exists but belongs to someone else
+    return kill(static_cast<pid_t>(id), 0) == 0 || errno == EPERM;
+#endif
+}
+
+void SharedMemory::close() {
+    if (bytes) {
+#ifdef _WIN32
+        UnmapViewOfFile(bytes);
+#else
+        munmap(bytes, length);
+#endif
+    }
+    bytes = nullptr;
+    length = 0;
+    owner = false;
+}
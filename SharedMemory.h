@@ -0,0 +1,60 @@
+#ifndef SHARED_MEMORY_H
+#define SHARED_MEMORY_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// A named block of memory that other processes can map by name.
+// Uses shm_open on POSIX and a paging-file backed CreateFileMapping on
+// Windows. Names are plain words; the "/" (POSIX) or "Local\" (Windows)
+// prefix is added here.
+// Reference -> https://man7.org/linux/man-pages/man7/shm_overview.7.html
+// Reference -> https://learn.microsoft.com/en-us/windows/win32/memory/creating-named-shared-memory
+class SharedMemory {
+public:
+    SharedMemory() = default;
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+    SharedMemory(SharedMemory&& other) noexcept;
+    SharedMemory& operator=(SharedMemory&& other) noexcept;
+
+    // Creates (or takes over) a writable segment of the given size. With
+    // exclusive set it fails quietly if the name is already in use, and
+    // taken() says so.
+    bool create(const std::string& name, size_t size, bool exclusive = false);
+    bool taken() const;
+    // Maps an existing segment, read-only unless asked otherwise. Quiet if it
+    // does not exist, since readers retry while a publisher swaps segments.
+    bool open(const std::string& name, bool writable = false);
+
+    bool isOpen() const;
+    const char* data() const;
+    // nullptr unless this side created the segment or opened it writable
+    char* writable() const;
+    size_t size() const;
+
+    // Takes the name away so nobody else can open the segment. Mappings
+    // already made stay valid until they are closed. Only the side that can
+    // write does this. On Windows the name goes by itself once the last
+    // mapping closes, so this does nothing.
+    void unlink();
+    void close();
+    // unlink() by name, for segments left behind by a process that died
+    static void remove(const std::string& name);
+
+    // For telling whether whoever made a segment is still running
+    static uint64_t processId();
+    static bool processAlive(uint64_t id);
+
+private:
+    std::string name;
+    char* bytes = nullptr;
+    size_t length = 0;
+    bool owner = false;
+    bool nameTaken = false;
+};
+
+#endif
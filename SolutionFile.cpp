@@ -0,0 +1,328 @@
+#include "SolutionFile.h"
+#include <climits>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    const char magic[4] = { 'M', 'A', 'Z', 'S' };
+    const uint8_t version = 1;
+    const int maxRun = 63;
+
+    // Same order as the Passage bits: North, South, West, East
+    const int stepRow[4] = { -1, 1, 0, 0 };
+    const int stepCol[4] = { 0, 0, -1, 1 };
+
+    // Small negative and positive numbers both become small unsigned ones
+    uint64_t zigzag(long long value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    long long unzigzag(uint64_t value) {
+        return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+    }
+}
+
+SolutionWriter::SolutionWriter(const std::string& filename, int rows, int cols)
+    : file(new BufferedFileWriter(filename)), rows(rows), cols(cols) {
+    if (!file->isOpen()) {
+        failed = true;
+        return;
+    }
+    begin();
+}
+
+SolutionWriter::SolutionWriter(std::vector<uint8_t>& out, int rows, int cols)
+    : memory(&out), rows(rows), cols(cols) {
+    begin();
+}
+
+bool SolutionWriter::isOpen() const {
+    return !failed;
+}
+
+void SolutionWriter::begin() {
+    for (char c : magic)
+        put(static_cast<uint8_t>(c));
+    put(version);
+    putVarint(static_cast<uint32_t>(rows));
+    putVarint(static_cast<uint32_t>(cols));
+}
+
+void SolutionWriter::put(uint8_t byte) {
+    if (memory)
+        memory->push_back(byte);
+    else if (!failed)
+        file->put(static_cast<char>(byte));
+}
+
+void SolutionWriter::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        put(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    put(static_cast<uint8_t>(value));
+}
+
+void SolutionWriter::flushRun() {
+    if (runLength == 0)
+        return;
+    put(static_cast<uint8_t>(runLength << 2 | runDirection));
+    runLength = 0;
+}
+
+void SolutionWriter::endSection() {
+    if (section == Section::Path)
+        flushRun();
+    if (section == Section::Path || section == Section::Visited)
+        put(0);
+}
+
+void SolutionWriter::beginPath(Point start) {
+    if (section != Section::None) {
+        failed = true;
+        return;
+    }
+    put('P');
+    putVarint(static_cast<uint32_t>(start.first));
+    putVarint(static_cast<uint32_t>(start.second));
+    last = start;
+    section = Section::Path;
+}
+
+bool SolutionWriter::addStep(Point next) {
+    if (section != Section::Path)
+        return false;
+    int d = 0;
+    while (d < 4 && (next.first - last.first != stepRow[d] || next.second - last.second != stepCol[d]))
+        d++;
+    if (d == 4)
+        return false;
+    if (runLength > 0 && (d != runDirection || runLength == maxRun))
+        flushRun();
+    runDirection = d;
+    runLength++;
+    last = next;
+    return true;
+}
+
+void SolutionWriter::beginVisited() {
+    if (section == Section::Visited || section == Section::Done) {
+        failed = true;
+        return;
+    }
+    endSection();
+    put('V');
+    lastIndex = 0;
+    section = Section::Visited;
+}
+
+void SolutionWriter::addVisited(Point p) {
+    if (section != Section::Visited)
+        return;
+    long long index = static_cast<long long>(p.first) * cols + p.second;
+    putVarint(zigzag(index - lastIndex) + 1);
+    lastIndex = index;
+}
+
+bool SolutionWriter::finish() {
+    if (section != Section::Done) {
+        endSection();
+        put('E');
+        section = Section::Done;
+        if (file && !file->close())
+            failed = true;
+    }
+    if (failed)
+        std::cerr << "Something went wrong writing the solution" << std::endl;
+    return !failed;
+}
+
+bool SolutionWriter::write(const std::vector<Point>& path, const std::vector<Point>& visited) {
+    if (!path.empty()) {
+        beginPath(path[0]);
+        for (size_t i = 1; i < path.size(); i++) {
+            if (!addStep(path[i]))
+                failed = true;
+        }
+    }
+    if (!visited.empty()) {
+        beginVisited();
+        for (const Point& p : visited)
+            addVisited(p);
+    }
+    return finish();
+}
+
+SolutionReader::SolutionReader(const uint8_t* data, size_t size) {
+    open(data, size);
+}
+
+bool SolutionReader::load(const std::string& filename) {
+    valid = false;
+    file = MappedFile(filename);
+    if (!file.isOpen())
+        return false;
+    open(reinterpret_cast<const uint8_t*>(file.data()), file.size());
+    if (!valid)
+        std::cerr << filename << " is not a solution file" << std::endl;
+    return valid;
+}
+
+void SolutionReader::open(const uint8_t* data, size_t size) {
+    start = data;
+    cursor = data;
+    end = data + size;
+    valid = damaged = pathPresent = false;
+    section = Section::Done;
+    if (size < sizeof(magic) + 1 || std::memcmp(data, magic, sizeof(magic)) != 0 || data[sizeof(magic)] != version)
+        return;
+    cursor += sizeof(magic) + 1;
+
+    uint64_t r, c;
+    if (!getVarint(r) || !getVarint(c) || r > INT_MAX || c > INT_MAX)
+        return;
+    rows = static_cast<int>(r);
+    cols = static_cast<int>(c);
+    valid = true;
+    nextSection();
+    pathPresent = section == Section::Path;
+}
+
+bool SolutionReader::isValid() const {
+    return valid && !damaged;
+}
+
+int SolutionReader::getRows() const {
+    return rows;
+}
+
+int SolutionReader::getCols() const {
+    return cols;
+}
+
+size_t SolutionReader::bytesUsed() const {
+    return static_cast<size_t>(cursor - start);
+}
+
+bool SolutionReader::hasPath() const {
+    return pathPresent;
+}
+
+bool SolutionReader::get(uint8_t& byte) {
+    if (cursor == end)
+        return false;
+    byte = *cursor++;
+    return true;
+}
+
+bool SolutionReader::getVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte;
+        if (!get(byte))
+            return false;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+void SolutionReader::nextSection() {
+    uint8_t tag = 0;
+    uint64_t r, c;
+    section = Section::Done;
+    if (!get(tag)) {
+        damaged = true;
+    }
+    else if (tag == 'P') {
+        if (!getVarint(r) || !getVarint(c) || r >= static_cast<uint64_t>(rows) || c >= static_cast<uint64_t>(cols)) {
+            damaged = true;
+            return;
+        }
+        last = { static_cast<int>(r), static_cast<int>(c) };
+        startPending = true;
+        runLeft = 0;
+        section = Section::Path;
+    }
+    else if (tag == 'V') {
+        lastIndex = 0;
+        section = Section::Visited;
+    }
+    else if (tag != 'E') {
+        damaged = true;
+    }
+}
+
+bool SolutionReader::nextStep(Point& p) {
+    if (section != Section::Path)
+        return false;
+    if (startPending) {
+        startPending = false;
+        p = last;
+        return true;
+    }
+    if (runLeft == 0) {
+        uint8_t run;
+        if (!get(run) || (run != 0 && run >> 2 == 0)) {
+            damaged = true;
+            section = Section::Done;
+            return false;
+        }
+        if (run == 0) {
+            nextSection();
+            return false;
+        }
+        runDirection = run & 3;
+        runLeft = run >> 2;
+    }
+    last.first += stepRow[runDirection];
+    last.second += stepCol[runDirection];
+    runLeft--;
+    if (last.first < 0 || last.first >= rows || last.second < 0 || last.second >= cols) {
+        damaged = true;
+        section = Section::Done;
+        return false;
+    }
+    p = last;
+    return true;
+}
+
+bool SolutionReader::nextVisited(Point& p) {
+    Point skipped;
+    while (nextStep(skipped)) {
+    }
+    if (section != Section::Visited)
+        return false;
+
+    uint64_t value;
+    if (!getVarint(value)) {
+        damaged = true;
+        section = Section::Done;
+        return false;
+    }
+    if (value == 0) {
+        nextSection();
+        return false;
+    }
+    long long index = lastIndex + unzigzag(value - 1);
+    if (index < 0 || index >= static_cast<long long>(rows) * cols) {
+        damaged = true;
+        section = Section::Done;
+        return false;
+    }
+    lastIndex = index;
+    p = { static_cast<int>(index / cols), static_cast<int>(index % cols) };
+    return true;
+}
+
+bool SolutionReader::read(std::vector<Point>& path, std::vector<Point>& visited) {
+    path.clear();
+    visited.clear();
+    Point p;
+    while (nextStep(p))
+        path.push_back(p);
+    while (nextVisited(p))
+        visited.push_back(p);
+    return isValid();
+}
@@ -0,0 +1,133 @@
+#ifndef SOLUTION_FILE_H
+#define SOLUTION_FILE_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "BufferedFileWriter.h"
+#include "MappedFile.h"
+
+// Compact form of a solver's result (Algorithms::getPath/getVisited), for
+// archiving solutions or sending them to another process. A Point costs 8
+// bytes in memory; here a path step costs a fraction of a byte and a
+// visited cell usually 1 or 2.
+//
+//  "MAZS", version byte, rows, cols             grid size in characters
+//  'P' start row, start col, runs..., 0         path, if there is one
+//  'V' deltas..., 0                             visited order, if kept
+//  'E'                                          end, so messages can be
+//                                               sent back to back
+//                                               (see bytesUsed())
+//
+// Path runs are one byte each: direction in the low 2 bits (the Passage bit
+// index, see Passages.h) and 1-63 steps that way in the high 6 bits, so a
+// long corridor is a single byte. Visited cells are row * cols + col, each
+// stored as the zigzagged difference from the one before plus 1, as a
+// LEB128 varint. Consecutive cells of a search are nearly always close.
+// Reference -> https://en.wikipedia.org/wiki/LEB128
+// Reference -> https://protobuf.dev/programming-guides/encoding/#signed-ints
+//
+// Both sides stream: the writer never holds more than a file chunk, and the
+// reader decodes one point at a time straight out of the mapped file.
+class SolutionWriter {
+public:
+    using Point = std::pair<int, int>;
+
+    // rows and cols are the character grid size of the maze
+    SolutionWriter(const std::string& filename, int rows, int cols);
+    SolutionWriter(std::vector<uint8_t>& out, int rows, int cols);
+
+    SolutionWriter(const SolutionWriter&) = delete;
+    SolutionWriter& operator=(const SolutionWriter&) = delete;
+
+    bool isOpen() const;
+
+    // Path first, then visited cells; either may be left out
+    void beginPath(Point start);
+    // Returns false if next is not a neighbour of the last point
+    bool addStep(Point next);
+    void beginVisited();
+    void addVisited(Point p);
+    // Writes the end marker. Returns false if anything went wrong.
+    bool finish();
+
+    // Whole solution in one go
+    bool write(const std::vector<Point>& path, const std::vector<Point>& visited);
+
+private:
+    enum class Section { None, Path, Visited, Done };
+
+    std::unique_ptr<BufferedFileWriter> file;
+    std::vector<uint8_t>* memory = nullptr;
+    int rows, cols;
+    Section section = Section::None;
+    bool failed = false;
+    Point last;
+    int runDirection = 0;
+    int runLength = 0;
+    long long lastIndex = 0;
+
+    void begin();
+    void put(uint8_t byte);
+    void putVarint(uint64_t value);
+    void flushRun();
+    void endSection();
+};
+
+class SolutionReader {
+public:
+    using Point = std::pair<int, int>;
+
+    SolutionReader() = default;
+    // The bytes must stay alive while reading
+    SolutionReader(const uint8_t* data, size_t size);
+
+    // Prints what went wrong and returns false if the file can't be read
+    bool load(const std::string& filename);
+
+    bool isValid() const;
+    int getRows() const;
+    int getCols() const;
+    bool hasPath() const;
+
+    // Next point of the path, start included. False once the path is done.
+    bool nextStep(Point& p);
+    // Next visited cell, skipping whatever is left of the path.
+    // False once they are all read.
+    bool nextVisited(Point& p);
+
+    // Whole solution in one go. Returns false if the data is damaged.
+    bool read(std::vector<Point>& path, std::vector<Point>& visited);
+
+    // Bytes read so far. After the end marker this is the size of the whole
+    // message, so the next one in the same buffer starts right there:
+    //   SolutionReader second(data + first.bytesUsed(), size - first.bytesUsed());
+    size_t bytesUsed() const;
+
+private:
+    enum class Section { None, Path, Visited, Done };
+
+    MappedFile file;
+    const uint8_t* start = nullptr;
+    const uint8_t* cursor = nullptr;
+    const uint8_t* end = nullptr;
+    bool valid = false;
+    bool damaged = false;
+    bool pathPresent = false;
+    int rows = 0, cols = 0;
+    Section section = Section::None;
+    Point last;
+    bool startPending = false;
+    int runDirection = 0;
+    int runLeft = 0;
+    long long lastIndex = 0;
+
+    void open(const uint8_t* data, size_t size);
+    bool get(uint8_t& byte);
+    bool getVarint(uint64_t& value);
+    void nextSection();
+};
+
+#endif
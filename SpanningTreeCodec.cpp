@@ -0,0 +1,120 @@
+#include "SpanningTreeCodec.h"
+#include "Passages.h"
+#include <algorithm>
+#include <bitset>
+#include <thread>
+
+namespace {
+    const int stepX[4] = { -1, 1, 0, 0 };
+    const int stepY[4] = { 0, 0, -1, 1 };
+}
+
+size_t SpanningTreeCodec::rowBytes(int cellCols) {
+    return (static_cast<size_t>(cellCols) + 3) / 4;
+}
+
+bool SpanningTreeCodec::encode(const std::vector<uint8_t>& cells, int cellRows, int cellCols, std::vector<uint8_t>& plane) {
+    plane.clear();
+    size_t count = static_cast<size_t>(cellRows) * cellCols;
+    if (count == 0 || cells.size() != count)
+        return false;
+
+    // a tree has exactly one passage fewer than it has cells
+    size_t ends = 0;
+    for (uint8_t mask : cells)
+        ends += std::bitset<4>(mask).count();
+    if (ends != 2 * (count - 1))
+        return false;
+
+    // ... and reaches every cell from the root
+    size_t stride = rowBytes(cellCols);
+    plane.assign(static_cast<size_t>(cellRows) * stride, 0);
+    std::vector<char> seen(count, 0);
+    std::vector<size_t> stack = { 0 };
+    seen[0] = 1;
+    size_t reached = 1;
+    while (!stack.empty()) {
+        size_t here = stack.back();
+        stack.pop_back();
+        int x = static_cast<int>(here / cellCols), y = static_cast<int>(here % cellCols);
+        for (int d = 0; d < 4; d++) {
+            if (!(cells[here] & (1 << d)))
+                continue;
+            int nx = x + stepX[d], ny = y + stepY[d];
+            size_t next = static_cast<size_t>(nx) * cellCols + ny;
+            if (seen[next])
+                continue;
+            seen[next] = 1;
+            reached++;
+            // the neighbour's parent is back the way we came
+            plane[static_cast<size_t>(nx) * stride + ny / 4] |= static_cast<uint8_t>((d ^ 1) << ((ny & 3) * 2));
+            stack.push_back(next);
+        }
+    }
+    if (reached != count) {
+        plane.clear();
+        return false;
+    }
+    return true;
+}
+
+uint8_t SpanningTreeCodec::parent(const uint8_t* plane, int cellCols, int x, int y) {
+    return (plane[static_cast<size_t>(x) * rowBytes(cellCols) + y / 4] >> ((y & 3) * 2)) & 3;
+}
+
+// A passage is open if either cell on its two sides has the other as parent
+uint8_t SpanningTreeCodec::passages(const uint8_t* plane, int cellRows, int cellCols, int x, int y) {
+    uint8_t mask = 0;
+    if (x != 0 || y != 0)
+        mask |= static_cast<uint8_t>(1 << parent(plane, cellCols, x, y));
+    if (x > 0 && parent(plane, cellCols, x - 1, y) == 1)
+        mask |= North;
+    if (x + 1 < cellRows && parent(plane, cellCols, x + 1, y) == 0)
+        mask |= South;
+    if (y > 0 && parent(plane, cellCols, x, y - 1) == 3)
+        mask |= West;
+    if (y + 1 < cellCols && parent(plane, cellCols, x, y + 1) == 2)
+        mask |= East;
+    return mask;
+}
+
+std::vector<std::string> SpanningTreeCodec::toMaze(const uint8_t* plane, int cellRows, int cellCols, int threads) {
+    int rows = 2 * cellRows + 1, cols = 2 * cellCols + 1;
+    if (cellRows == 0 || cellCols == 0)
+        return std::vector<std::string>(rows, std::string(cols, '#'));
+    std::vector<std::string> maze(rows);
+    maze[0].assign(cols, '#');
+
+    // cell row x fills character rows 2x + 1 and 2x + 2 and reads only the
+    // plane, so bands never touch the same row
+    auto expandRows = [&](int first, int last) {
+        for (int x = first; x < last; x++) {
+            std::string& line = maze[2 * x + 1];
+            std::string& below = maze[2 * x + 2];
+            line.assign(cols, '#');
+            below.assign(cols, '#');
+            for (int y = 0; y < cellCols; y++) {
+                uint8_t own = x == 0 && y == 0 ? 0xFF : parent(plane, cellCols, x, y);
+                line[2 * y + 1] = '.';
+                if (own == 3 || (y + 1 < cellCols && parent(plane, cellCols, x, y + 1) == 2))
+                    line[2 * y + 2] = '.';
+                if (own == 1 || (x + 1 < cellRows && parent(plane, cellCols, x + 1, y) == 0))
+                    below[2 * y + 1] = '.';
+            }
+        }
+    };
+
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::max(1, std::min(threads, cellRows));
+    int band = (cellRows + threads - 1) / threads;
+    std::vector<std::thread> pool;
+    for (int first = 0; first < cellRows; first += band)
+        pool.emplace_back(expandRows, first, std::min(cellRows, first + band));
+    for (auto& t : pool)
+        t.join();
+
+    maze[0][1] = '.';
+    maze[rows - 1][cols - 2] = '.';
+    return maze;
+}
@@ -0,0 +1,35 @@
+#ifndef SPANNING_TREE_CODEC_H
+#define SPANNING_TREE_CODEC_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// A perfect maze is a spanning tree of its cells, so it is fully described
+// by which way every cell's parent is: 2 bits per cell (the Passage bit
+// index, see Passages.h), rooted at the entrance cell (0, 0). The root has
+// no parent and stores 0 (North), which no cell in row 0 could point to.
+//
+// The plane is stored row by row, 4 cells per byte, lowest bits first, each
+// row padded to a whole byte. Any cell's passages can be worked out from its
+// own parent and those of its four neighbours, so decoding needs no search
+// and row bands decode on separate threads.
+class SpanningTreeCodec {
+public:
+    static size_t rowBytes(int cellCols);
+
+    // Returns false (and leaves plane empty) if the passage masks are not a
+    // single spanning tree, e.g. a braided maze
+    static bool encode(const std::vector<uint8_t>& cells, int cellRows, int cellCols, std::vector<uint8_t>& plane);
+
+    // Direction from cell (x, y) towards the root
+    static uint8_t parent(const uint8_t* plane, int cellCols, int x, int y);
+    static uint8_t passages(const uint8_t* plane, int cellRows, int cellCols, int x, int y);
+
+    // Whole 2x+1 character grid, entrance and exit included.
+    // threads <= 0 means use std::thread::hardware_concurrency()
+    static std::vector<std::string> toMaze(const uint8_t* plane, int cellRows, int cellCols, int threads = 0);
+};
+
+#endif
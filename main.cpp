@@ -1,7 +1,26 @@
 #include "MazeRenderer.h"
 #include "MazeGenerator.h"
+#include "AsyncMazeLoader.h"
+#include "ImageExporter.h"
+#include "Algorithms.h"
+#include "SharedMaze.h"
+#include "MazeIndexFile.h"
+#include "InfiniteMaze.h"
+#include "EllerGenerator.h"
+#include "BinaryMazeFile.h"
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
 
-int main() {
+// Usage: MazeSolver [--export image.png] [--publish name] [--index] [seed | maze.txt | maze.mzb]
+//        MazeSolver [--publish name] --infinite cellRow cellCol [seed]
+//        MazeSolver --stream maze.txt rows cols [seed]
+//        MazeSolver --save maze.mzb [--encoding bits|passages|compressed|tree] [seed | maze.txt | maze.mzb]
+int main(int argc, char* argv[]) {
     // Step 1: Generate a new maze with at least 100,000 elements
     int rows = 401;  // Must be odd to work with the maze generation algorithm
     int cols = 251;  // Same here
@@ -9,11 +28,226 @@ int main() {
     int windowWidth = 1800;
     int windowHeight = 800;
 
-    MazeGenerator generator(rows, cols);
-    generator.generate();
+    // --export solves the maze with BFS and saves a picture instead of opening a window.
+    // --publish shares the maze on screen with solver processes while the window
+    // is open, and shares the new one each time it changes.
+    // --index writes the sidecar index of a maze file (see MazeIndexFile.h) and stops.
+    // --stream writes a maze of any height straight to a text file with
+    // Eller's algorithm (see EllerGenerator.h), never holding more than a row.
+    // --infinite shows the seed's infinite maze (see InfiniteMaze.h) from the
+    // given cell on; the arrow keys move around it.
+    // --save writes the maze as a binary maze file (see BinaryMazeFile.h) and
+    // stops. --encoding picks how, compressed by default.
+    std::string exportTo, publishAs;
+    std::string saveTo, encodingName;
+    bool writeIndex = false;
+    std::string streamTo;
+    long long streamRows = 0;
+    long long streamCols = 0;
+    bool exploreInfinite = false;
+    int64_t infiniteRow = 0, infiniteCol = 0;
+    auto parseCell = [](const char* text, int64_t& cell) {
+        const char* end = text + std::strlen(text);
+        auto result = std::from_chars(text, end, cell);
+        return result.ec == std::errc() && result.ptr == end && cell >= 0 && cell < InfiniteMaze::side;
+    };
+    while (argc > 1 && std::string(argv[1]).rfind("--", 0) == 0) {
+        std::string option = argv[1];
+        if (option == "--index") {
+            writeIndex = true;
+            argc--;
+            argv++;
+        }
+        else if (argc > 4 && option == "--stream") {
+            auto parseSize = [](const char* text, long long& size) {
+                const char* end = text + std::strlen(text);
+                auto result = std::from_chars(text, end, size);
+                return result.ec == std::errc() && result.ptr == end;
+            };
+            if (!parseSize(argv[3], streamRows) || !parseSize(argv[4], streamCols) || streamCols > INT_MAX) {
+                std::cerr << "--stream needs a file name, a row count and a column count" << std::endl;
+                return 1;
+            }
+            streamTo = argv[2];
+            argc -= 4;
+            argv += 4;
+        }
+        else if (argc > 3 && option == "--infinite") {
+            if (!parseCell(argv[2], infiniteRow) || !parseCell(argv[3], infiniteCol)) {
+                std::cerr << "--infinite needs a cell row and column from 0 to " << InfiniteMaze::side - 1 << std::endl;
+                return 1;
+            }
+            exploreInfinite = true;
+            argc -= 3;
+            argv += 3;
+        }
+        else if (argc > 2 && (option == "--save" || option == "--encoding")) {
+            (option == "--save" ? saveTo : encodingName) = argv[2];
+            argc -= 2;
+            argv += 2;
+        }
+        else if (argc > 2 && (option == "--export" || option == "--publish")) {
+            (option == "--export" ? exportTo : publishAs) = argv[2];
+            argc -= 2;
+            argv += 2;
+        }
+        else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+
+    MazeEncoding encoding = MazeEncoding::Compressed;
+    if (!encodingName.empty()) {
+        const char* names[] = { "bits", "passages", "compressed", "tree" };
+        auto found = std::find(std::begin(names), std::end(names), encodingName);
+        if (found == std::end(names) || saveTo.empty()) {
+            std::cerr << "--encoding goes with --save and is one of bits, passages, compressed or tree" << std::endl;
+            return 1;
+        }
+        encoding = static_cast<MazeEncoding>(found - std::begin(names));
+    }
+
+    std::string arg = argc > 1 ? argv[1] : "";
+    bool isSeed = !arg.empty() && arg.find_first_not_of("0123456789") == std::string::npos;
+
+    // Step 2: or load one from a file, e.g. solvable_large_maze.txt. Only the
+    // header is read here, the rows follow on a worker thread so the window
+    // can open straight away.
+    std::unique_ptr<AsyncMazeLoader> loader;
+    uint64_t seed = Rng::randomSeed();
+    if (isSeed && !Rng::parseSeed(arg, seed)) {
+        std::cerr << arg << " is not a valid seed, it has to fit in 64 bits" << std::endl;
+        return 1;
+    }
+    if (!arg.empty() && !isSeed) {
+        // --index writes the sidecar, so it must not map it; --export and
+        // --save have no use for labels at all
+        AsyncMazeLoader::Labels labels = writeIndex ? AsyncMazeLoader::Labels::Compute :
+            !exportTo.empty() || !saveTo.empty() ? AsyncMazeLoader::Labels::Skip : AsyncMazeLoader::Labels::UseIndex;
+        loader = std::make_unique<AsyncMazeLoader>();
+        if (!loader->start(arg, labels))
+            return 1;
+        rows = loader->getRows();
+        cols = loader->getCols();
+        if (loader->hasSeed())
+            seed = loader->getSeed();
+        std::cout << "Loading " << arg << " (" << rows << " x " << cols << ")" << std::endl;
+    }
+    if (!streamTo.empty()) {
+        if (loader || exploreInfinite || writeIndex || !exportTo.empty() || !publishAs.empty() || !saveTo.empty()) {
+            std::cerr << "--stream only takes a seed" << std::endl;
+            return 1;
+        }
+        std::cout << "Maze seed: " << seed << std::endl;
+        EllerGenerator eller(streamRows, static_cast<int>(streamCols), seed);
+        FileRowSink sink(streamTo, "seed=" + std::to_string(seed) + " generator=Eller");
+        if (!sink.isOpen() || !eller.generate(sink) || !sink.finish())
+            return 1;
+        std::cout << "Wrote " << streamTo << " (" << eller.getRows() << " x " << eller.getCols() << ")" << std::endl;
+        return 0;
+    }
+    if (exploreInfinite && (loader || writeIndex || !exportTo.empty())) {
+        std::cerr << "--infinite only takes a seed and opens a window" << std::endl;
+        return 1;
+    }
+    if (!saveTo.empty() && (exploreInfinite || writeIndex || !exportTo.empty() || !publishAs.empty())) {
+        std::cerr << "--save only takes a seed or a maze file" << std::endl;
+        return 1;
+    }
+    if (writeIndex && !loader) {
+        std::cerr << "--index needs a maze file" << std::endl;
+        return 1;
+    }
+
+    // Pass a seed to get the exact same maze again, otherwise pick a random one
+    std::cout << "Maze seed: " << seed << std::endl;
+
+    MazeGenerator generator(rows, cols, seed);
+    if (!loader)
+        generator.generate();
+
+    // Everything but the window needs the whole maze up front
+    std::vector<std::string> maze;
+    ComponentLabeler components;
+    if (!exportTo.empty() || writeIndex || (loader && !saveTo.empty())) {
+        if (loader && !loader->wait())
+            return 1;
+        if (loader) {
+            maze = loader->takeMaze();
+            components = loader->takeComponents();
+        }
+        else {
+            for (const auto& row : generator.getMaze())
+                maze.emplace_back(row.begin(), row.end());
+        }
+    }
+
+    // Component labels for the sidecar index, so the next start can map
+    // them instead of labelling the whole maze again. The loader has already
+    // worked them out.
+    if (writeIndex) {
+        std::string sidecar = MazeIndexFile::sidecarFor(arg);
+        MazeIndexWriter writer(rows, cols, seed, MazeIndexFile::fingerprint(maze));
+        writer.addComponents(components);
+        if (!writer.save(sidecar))
+            return 1;
+        std::cout << "Wrote " << sidecar << std::endl;
+        return 0;
+    }
+
+    // A maze file keeps its seed if it has one. Anything but Bits needs it to
+    // be laid out like a generated maze, which Bits falls back to unless
+    // asked for something else.
+    if (!saveTo.empty()) {
+        bool saved;
+        if (!loader) {
+            saved = BinaryMazeFile::save(saveTo, generator, 64, encoding);
+        }
+        else {
+            uint64_t fileSeed = loader->hasSeed() ? seed : 0;
+            std::vector<uint8_t> cells;
+            bool lattice = encoding != MazeEncoding::Bits && BinaryMazeFile::passagesOf(maze, cells);
+            if (!lattice && !encodingName.empty() && encoding != MazeEncoding::Bits) {
+                std::cerr << arg << " is not laid out as cells with walls in between, only --encoding bits can save it" << std::endl;
+                return 1;
+            }
+            if (lattice)
+                saved = BinaryMazeFile::save(saveTo, cells, rows / 2, cols / 2, fileSeed, BinaryMazeFile::unknownGenerator, 64, encoding);
+            else
+                saved = BinaryMazeFile::save(saveTo, BitGrid::fromMaze(maze), fileSeed);
+        }
+        if (!saved)
+            return 1;
+        std::cout << "Wrote " << saveTo << std::endl;
+        return 0;
+    }
+
+    if (!exportTo.empty()) {
+        Algorithms solver = loader ? Algorithms(maze) :
+            Algorithms(generator.getPassages(), generator.getCellRows(), generator.getCellCols());
+        solver.runBFS({ 0, 1 }, { rows - 1, cols - 2 });
+        ImageExporter exporter(maze);
+        exporter.setVisited(solver.getVisited());
+        exporter.setPath(solver.getPath());
+        return exporter.write(exportTo, ImageExporter::formatFor(exportTo)) ? 0 : 1;
+    }
+
+    // Solvers open it with SharedMazeReader until the window is closed. The
+    // renderer publishes each maze as it goes on screen.
+    std::unique_ptr<SharedMazePublisher> publisher;
+    if (!publishAs.empty()) {
+        publisher = std::make_unique<SharedMazePublisher>(publishAs);
+        if (!publisher->isOpen())
+            return 1;
+        std::cout << "Publishing as " << publishAs << std::endl;
+    }
 
     // Step 3: Run the renderer
-    MazeRenderer renderer(generator, tileSize, windowWidth, windowHeight);
+    MazeRenderer renderer(generator, tileSize, windowWidth, windowHeight, std::move(loader), publisher.get());
+    InfiniteMaze infinite(seed);
+    if (exploreInfinite)
+        renderer.explore(infinite, infiniteRow, infiniteCol);
     renderer.run();
 
     return 0;